@@ -19,3 +19,17 @@ if(USE_SYSTEM_DEPS)
 else()
     # fetchcontent
 endif()
+
+# egl, optional, only the offscreen backend behind --render needs it
+if(UNIX AND NOT APPLE)
+    find_package(OpenGL COMPONENTS EGL)
+    if(OpenGL_EGL_FOUND)
+        add_library(dep::egl ALIAS OpenGL::EGL)
+    else()
+        message(STATUS "EGL not found, building without offscreen rendering (--render)")
+    endif()
+endif()
+
+# threads
+find_package(Threads REQUIRED)
+add_library(dep::threads ALIAS Threads::Threads)
@@ -10,6 +10,7 @@ option(ENABLE_UBSAN          "Enable UndefinedBehaviorSanitizer" OFF)
 option(ENABLE_TSAN           "Enable ThreadSanitizer" OFF)
 
 option(ENABLE_LTO            "Enable link-time optimization (IPO/LTO)" OFF)
+option(ENABLE_AVX            "Build with AVX, frustum culling tests 8 bounds at a time" OFF)
 
 option(ENABLE_SHADER_BUILD   "Compile shaders during build" ON)
 option(ENABLE_ASSET_STAGING  "Copy/symlink assets next to binaries" ON)
@@ -28,3 +29,11 @@ if (ENABLE_LTO)
         message(WARNING "IPO/LTO requested but not supported: ${ipo_err}")
     endif()
 endif()
+
+if (ENABLE_AVX)
+    if (MSVC)
+        target_compile_options(project_options INTERFACE /arch:AVX)
+    else()
+        target_compile_options(project_options INTERFACE -mavx)
+    endif()
+endif()
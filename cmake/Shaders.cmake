@@ -0,0 +1,37 @@
+include_guard(GLOBAL)
+
+# Runs every shader through glslangValidator as part of building `target`, so a shader that does
+# not compile fails the build instead of the next launch. Stamp files keep unchanged shaders from
+# being checked again.
+function(add_shader_validation target)
+    if (NOT ENABLE_SHADER_BUILD)
+        return()
+    endif()
+
+    find_program(GLSLANG_VALIDATOR NAMES glslangValidator glslang)
+    if (NOT GLSLANG_VALIDATOR)
+        message(WARNING "ENABLE_SHADER_BUILD is on but glslangValidator was not found, shaders will only be checked at runtime")
+        return()
+    endif()
+
+    set(_stamp_dir "${CMAKE_CURRENT_BINARY_DIR}/shaders")
+    set(_stamps "")
+    foreach(_shader IN LISTS ARGN)
+        get_filename_component(_name ${_shader} NAME)
+        set(_stamp "${_stamp_dir}/${_name}.checked")
+
+        add_custom_command(
+            OUTPUT ${_stamp}
+            COMMAND ${CMAKE_COMMAND} -E make_directory ${_stamp_dir}
+            COMMAND ${GLSLANG_VALIDATOR} ${_shader}
+            COMMAND ${CMAKE_COMMAND} -E touch ${_stamp}
+            DEPENDS ${_shader}
+            COMMENT "Validating ${_name}"
+            VERBATIM
+        )
+        list(APPEND _stamps ${_stamp})
+    endforeach()
+
+    add_custom_target(${target}_shaders DEPENDS ${_stamps})
+    add_dependencies(${target} ${target}_shaders)
+endfunction()
@@ -18,7 +18,7 @@ FetchContent_MakeAvailable(Catch2)
 
 function(add_game_test name)
     set(options)
-    set(oneValueArgs LABEL)
+    set(oneValueArgs LABEL TIMEOUT)
     set(multiValueArgs LABELS SOURCES)
     cmake_parse_arguments(T "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN})
 
@@ -27,7 +27,7 @@ function(add_game_test name)
     endif()
 
     add_executable(${name} ${T_SOURCES})
-    target_link_libraries(${name} PRIVATE project_options project_warnings Catch2::Catch2WithMain)
+    target_link_libraries(${name} PRIVATE project_options project_warnings dep::threads Catch2::Catch2WithMain)
 
     add_test(NAME ${name} COMMAND ${name})
 
@@ -42,5 +42,13 @@ function(add_game_test name)
         set_tests_properties(${name} PROPERTIES LABELS "${_labels}")
     endif()
 
-    set_tests_properties(${name} PROPERTIES TIMEOUT 30)
+    # benchmarks sample every case many times and scripts/test.sh runs them from Debug builds
+    if (NOT T_TIMEOUT)
+        if ("bench" IN_LIST _labels)
+            set(T_TIMEOUT 300)
+        else()
+            set(T_TIMEOUT 30)
+        endif()
+    endif()
+    set_tests_properties(${name} PROPERTIES TIMEOUT ${T_TIMEOUT})
 endfunction()
@@ -0,0 +1,39 @@
+#version 330 core
+
+layout (location = 0) in vec3 aPos;       // unorm16 for packed meshes
+layout (location = 1) in vec3 aNormal;    // float meshes only
+layout (location = 2) in vec2 aUV;        // half floats for packed meshes
+layout (location = 3) in mat4 aModel;     // per instance, takes locations 3-6
+layout (location = 7) in vec2 aOctNormal; // packed meshes only, octahedral snorm16
+
+// streamed once per frame, rows as laid out by Mat4
+layout (std140, row_major) uniform Frame {
+    mat4 uViewProj;
+};
+
+// packed positions are stored inside the mesh's bounds, identity for float meshes
+uniform vec3 uPositionScale;
+uniform vec3 uPositionOffset;
+uniform bool uPackedNormals;
+
+out vec3 vNormal;
+out vec2 vUV;
+
+// Matches octDecode in vertex_format.h.
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 signs = vec2(e.x >= 0.0 ? 1.0 : -1.0, e.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(e.yx)) * signs;
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = uPositionOffset + aPos * uPositionScale;
+    vec3 normal = uPackedNormals ? octDecode(aOctNormal) : aNormal;
+
+    gl_Position = uViewProj * aModel * vec4(position, 1.0);
+    vNormal = mat3(transpose(inverse(aModel))) * normal;
+    vUV = aUV;
+}
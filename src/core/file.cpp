@@ -0,0 +1,16 @@
+#include <fstream>
+#include <sstream>
+
+#include "file.h"
+
+bool readTextFile(const char *path, std::string &out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    out = contents.str();
+    return true;
+}
@@ -0,0 +1,9 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include <string>
+
+// Whole file as a string, false if it could not be opened.
+[[nodiscard]] bool readTextFile(const char *path, std::string &out);
+
+#endif
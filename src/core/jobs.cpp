@@ -0,0 +1,196 @@
+#include <format>
+
+#include "assert.h"
+#include "jobs.h"
+#include "logger.h"
+
+// index into JobSystem::queues for the current thread, the owning thread is 0
+static thread_local std::uint32_t workerIndex = 0;
+
+static void pushJob(JobSystem &jobs, Job job) {
+    // count before publishing so a thief can never take pending below zero
+    {
+        std::lock_guard<std::mutex> lock(jobs.sleepMutex);
+        jobs.pending++;
+    }
+
+    WorkerQueue &queue = *jobs.queues[workerIndex < jobs.workerCount() ? workerIndex : 0];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    jobs.wake.notify_one();
+}
+
+static bool popJob(JobSystem &jobs, Job &out) {
+    std::uint32_t count = jobs.workerCount();
+    std::uint32_t self = workerIndex < count ? workerIndex : 0;
+
+    {
+        WorkerQueue &own = *jobs.queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            out = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            jobs.pending--;
+            return true;
+        }
+    }
+
+    for (std::uint32_t i = 1; i < count; ++i) {
+        WorkerQueue &victim = *jobs.queues[(self + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            out = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            jobs.pending--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void finishJob(JobSystem &jobs, JobCounter *signal) {
+    if (signal == nullptr) {
+        return;
+    }
+
+    // The decrement happens under the counter's lock so waitForCounter can't return (and let
+    // the owner destroy the counter) while we are still touching it.
+    std::vector<Job> ready;
+    {
+        std::lock_guard<std::mutex> lock(signal->mutex);
+        if (signal->value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            ready.swap(signal->continuations);
+        }
+    }
+
+    for (Job &job : ready) {
+        pushJob(jobs, std::move(job));
+    }
+}
+
+static void runJob(JobSystem &jobs, Job &job) {
+    job.fn();
+    finishJob(jobs, job.signal);
+}
+
+static void workerMain(JobSystem *jobs, std::uint32_t index) {
+    workerIndex = index;
+
+    while (jobs->running.load(std::memory_order_acquire)) {
+        Job job;
+        if (popJob(*jobs, job)) {
+            runJob(*jobs, job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(jobs->sleepMutex);
+        jobs->wake.wait(lock, [jobs] {
+            return jobs->pending.load() > 0 || !jobs->running.load(std::memory_order_acquire);
+        });
+    }
+}
+
+void initJobSystem(JobSystem &jobs, std::uint32_t workerCount) {
+    ASSERT(jobs.queues.empty());
+
+    if (workerCount == 0) {
+        workerCount = std::thread::hardware_concurrency();
+    }
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+
+    workerIndex = 0;
+    jobs.running = true;
+
+    for (std::uint32_t i = 0; i < workerCount; ++i) {
+        jobs.queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (std::uint32_t i = 1; i < workerCount; ++i) {
+        jobs.threads.emplace_back(workerMain, &jobs, i);
+    }
+
+    Log(LogLevel::DEBUG, std::format("[Jobs] Started {} worker(s)", workerCount).c_str());
+}
+
+void shutdownJobSystem(JobSystem &jobs) {
+    {
+        std::lock_guard<std::mutex> lock(jobs.sleepMutex);
+        jobs.running = false;
+    }
+    jobs.wake.notify_all();
+
+    for (std::thread &thread : jobs.threads) {
+        thread.join();
+    }
+
+    jobs.threads.clear();
+    jobs.queues.clear();
+    jobs.pending = 0;
+}
+
+void submitJob(JobSystem &jobs, std::function<void()> fn, JobCounter *signal) {
+    if (signal != nullptr) {
+        signal->value.fetch_add(1, std::memory_order_relaxed);
+    }
+    pushJob(jobs, Job{std::move(fn), signal});
+}
+
+void submitJobAfter(JobSystem &jobs, JobCounter &dependency, std::function<void()> fn,
+                    JobCounter *signal) {
+    if (signal != nullptr) {
+        signal->value.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (dependency.value.load(std::memory_order_acquire) > 0) {
+            dependency.continuations.push_back(Job{std::move(fn), signal});
+            return;
+        }
+    }
+
+    pushJob(jobs, Job{std::move(fn), signal});
+}
+
+void waitForCounter(JobSystem &jobs, JobCounter &counter) {
+    while (counter.value.load(std::memory_order_acquire) > 0) {
+        Job job;
+        if (popJob(jobs, job)) {
+            runJob(jobs, job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // pairs with the locked decrement in finishJob
+    std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void parallelFor(JobSystem &jobs, std::uint32_t begin, std::uint32_t end, std::uint32_t grain,
+                 const std::function<void(std::uint32_t, std::uint32_t)> &fn) {
+    if (begin >= end) {
+        return;
+    }
+    if (grain == 0) {
+        grain = 1;
+    }
+
+    // not worth the scheduling overhead
+    if (end - begin <= grain || jobs.workerCount() <= 1) {
+        fn(begin, end);
+        return;
+    }
+
+    JobCounter counter;
+    for (std::uint32_t start = begin; start < end; start += grain) {
+        std::uint32_t stop = (end - start > grain) ? start + grain : end;
+        submitJob(jobs, [&fn, start, stop] { fn(start, stop); }, &counter);
+    }
+
+    waitForCounter(jobs, counter);
+}
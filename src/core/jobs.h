@@ -0,0 +1,69 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing job scheduler. Every worker owns a deque: it pushes and pops its own jobs at the
+// back (newest first, hot in cache) while idle workers steal from the front of the others.
+// The thread that calls initJobSystem is worker 0 and runs jobs whenever it waits on a counter.
+
+struct JobCounter;
+
+struct Job {
+    std::function<void()> fn;
+    JobCounter *signal = nullptr;
+};
+
+// Counts outstanding jobs. It is incremented when a job that signals it is submitted and
+// decremented when that job finishes, jobs submitted with submitJobAfter run once it hits zero.
+struct JobCounter {
+    std::atomic<std::int32_t> value{0};
+
+    std::mutex mutex;
+    std::vector<Job> continuations;
+};
+
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Job> jobs;
+};
+
+struct JobSystem {
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::atomic<bool> running{false};
+    std::atomic<std::uint32_t> pending{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+
+    std::uint32_t workerCount() const {
+        return static_cast<std::uint32_t>(queues.size());
+    }
+};
+
+// workerCount includes the calling thread, 0 picks one worker per hardware thread.
+void initJobSystem(JobSystem &jobs, std::uint32_t workerCount = 0);
+void shutdownJobSystem(JobSystem &jobs);
+
+void submitJob(JobSystem &jobs, std::function<void()> fn, JobCounter *signal = nullptr);
+void submitJobAfter(JobSystem &jobs, JobCounter &dependency, std::function<void()> fn,
+                    JobCounter *signal = nullptr);
+
+// Runs queued jobs on the calling thread until the counter reaches zero.
+void waitForCounter(JobSystem &jobs, JobCounter &counter);
+
+// Splits [begin, end) into ranges of at most `grain` items, runs them across all workers and
+// returns once every range is done.
+void parallelFor(JobSystem &jobs, std::uint32_t begin, std::uint32_t end, std::uint32_t grain,
+                 const std::function<void(std::uint32_t, std::uint32_t)> &fn);
+
+#endif
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <array>
+#include <format>
+#include <fstream>
+
+#include "logger.h"
+#include "png.h"
+
+// deflate stored blocks carry at most 65535 bytes each
+constexpr std::size_t PNG_STORED_BLOCK_SIZE = 65535;
+
+static std::array<std::uint32_t, 256> makeCrcTable() {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t n = 0; n < 256; ++n) {
+        std::uint32_t c = n;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        }
+        table[n] = c;
+    }
+    return table;
+}
+
+std::uint32_t crc32(const std::uint8_t *data, std::size_t size, std::uint32_t crc) {
+    static const std::array<std::uint32_t, 256> table = makeCrcTable();
+
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static void putU32(std::vector<std::uint8_t> &out, std::uint32_t value) {
+    out.insert(out.end(), {(std::uint8_t)(value >> 24), (std::uint8_t)(value >> 16),
+                           (std::uint8_t)(value >> 8), (std::uint8_t)value});
+}
+
+// length, type, data, then the CRC over type and data
+static void putChunk(std::vector<std::uint8_t> &out, const char type[4],
+                     const std::vector<std::uint8_t> &data) {
+    putU32(out, static_cast<std::uint32_t>(data.size()));
+    std::size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putU32(out, crc32(out.data() + start, out.size() - start));
+}
+
+void encodePng(std::uint32_t width, std::uint32_t height, const std::uint8_t *rgba,
+               std::vector<std::uint8_t> &out) {
+    out.clear();
+    out.insert(out.end(), {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'});
+
+    std::vector<std::uint8_t> header;
+    putU32(header, width);
+    putU32(header, height);
+    // bit depth 8, color type 6 (RGBA), deflate, adaptive filtering, no interlace
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+    putChunk(out, "IHDR", header);
+
+    // every row starts with its filter type, 0 for none
+    std::size_t rowSize = (std::size_t)width * 4;
+    std::vector<std::uint8_t> raw;
+    raw.reserve((rowSize + 1) * height);
+    for (std::uint32_t y = 0; y < height; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgba + y * rowSize, rgba + (y + 1) * rowSize);
+    }
+
+    // zlib stream: header without a preset dictionary, stored blocks, adler32 of the raw bytes
+    std::vector<std::uint8_t> data;
+    data.reserve(raw.size() + raw.size() / PNG_STORED_BLOCK_SIZE * 5 + 16);
+    data.insert(data.end(), {0x78, 0x01});
+
+    std::size_t offset = 0;
+    do {
+        std::size_t size = std::min(PNG_STORED_BLOCK_SIZE, raw.size() - offset);
+        bool last = offset + size == raw.size();
+        std::uint16_t length = static_cast<std::uint16_t>(size);
+        data.insert(data.end(), {(std::uint8_t)(last ? 1 : 0), (std::uint8_t)length,
+                                 (std::uint8_t)(length >> 8), (std::uint8_t)~length,
+                                 (std::uint8_t)(~length >> 8)});
+        data.insert(data.end(), raw.begin() + (std::ptrdiff_t)offset,
+                    raw.begin() + (std::ptrdiff_t)(offset + size));
+        offset += size;
+    } while (offset < raw.size());
+
+    std::uint32_t a = 1, b = 0;
+    for (std::uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    putU32(data, (b << 16) | a);
+
+    putChunk(out, "IDAT", data);
+    putChunk(out, "IEND", {});
+}
+
+bool writePng(const char *path, std::uint32_t width, std::uint32_t height,
+              const std::uint8_t *rgba) {
+    std::vector<std::uint8_t> png;
+    encodePng(width, height, rgba, png);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(png.data()), (std::streamsize)png.size());
+    if (!file) {
+        Log(LogLevel::ERROR, std::format("Could not write {}", path).c_str());
+        return false;
+    }
+    return true;
+}
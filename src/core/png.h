@@ -0,0 +1,22 @@
+#ifndef PNG_H
+#define PNG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Minimal PNG writer for frame captures. 8-bit RGBA, no filtering and the image data in stored
+// (uncompressed) deflate blocks, so it needs no zlib. Files are large but byte-for-byte the same
+// for the same pixels, which is what golden image comparisons want.
+
+// `rgba` is width * height * 4 bytes, rows top to bottom.
+void encodePng(std::uint32_t width, std::uint32_t height, const std::uint8_t *rgba,
+               std::vector<std::uint8_t> &out);
+// Logs and returns false when the file can't be written.
+bool writePng(const char *path, std::uint32_t width, std::uint32_t height,
+              const std::uint8_t *rgba);
+
+[[nodiscard]] std::uint32_t crc32(const std::uint8_t *data, std::size_t size,
+                                  std::uint32_t crc = 0);
+
+#endif
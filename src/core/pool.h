@@ -0,0 +1,90 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "assert.h"
+
+struct PoolStats {
+    std::size_t capacity = 0; // slots backed by memory
+    std::size_t used = 0;     // slots currently handed out
+    std::size_t peak = 0;     // highest `used` seen
+    std::size_t chunks = 0;
+    std::uint64_t allocations = 0;
+    std::uint64_t releases = 0;
+};
+
+// Fixed-size object pool. Memory is grabbed in chunks of SlotsPerChunk slots that are never
+// returned to the heap until the pool is destroyed, released slots are threaded onto a free list
+// and reused first. Pointers stay stable for the lifetime of the object.
+template <typename T, std::size_t SlotsPerChunk = 256> struct Pool {
+    static_assert(SlotsPerChunk > 0);
+
+    union Slot {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<Slot *> chunks;
+    Slot *freeList = nullptr;
+    // bump cursor into the newest chunk
+    std::size_t chunkCursor = SlotsPerChunk;
+    PoolStats stats;
+
+    Pool() = default;
+    Pool(const Pool &) = delete;
+    Pool &operator=(const Pool &) = delete;
+
+    ~Pool() {
+        // objects still alive are not destructed, callers own their lifetime
+        for (Slot *chunk : chunks) {
+            delete[] chunk;
+        }
+    }
+
+    template <typename... Args> [[nodiscard]] T *alloc(Args &&...args) {
+        Slot *slot;
+        if (freeList != nullptr) {
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (chunkCursor == SlotsPerChunk) {
+                chunks.push_back(new Slot[SlotsPerChunk]);
+                chunkCursor = 0;
+                stats.chunks++;
+                stats.capacity += SlotsPerChunk;
+            }
+            slot = &chunks.back()[chunkCursor++];
+        }
+
+        stats.allocations++;
+        stats.used++;
+        if (stats.used > stats.peak) {
+            stats.peak = stats.used;
+        }
+
+        return new (slot->storage) T(std::forward<Args>(args)...);
+    }
+
+    void release(T *object) {
+        if (object == nullptr) {
+            return;
+        }
+        ASSERT(stats.used > 0);
+
+        object->~T();
+
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = freeList;
+        freeList = slot;
+
+        stats.releases++;
+        stats.used--;
+    }
+};
+
+#endif
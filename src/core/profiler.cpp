@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <format>
+#include <limits>
+
+#include "assert.h"
+#include "logger.h"
+#include "profiler.h"
+
+static std::int64_t now() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+static float ticksToMs(std::int64_t ticks) {
+    using Period = std::chrono::steady_clock::period;
+    return (float)((double)ticks * Period::num / Period::den * 1000.0);
+}
+
+static void clearRow(ProfileRow &row, std::uint64_t frame) {
+    row.frame = frame;
+    std::fill(std::begin(row.values), std::end(row.values),
+              std::numeric_limits<float>::quiet_NaN());
+}
+
+std::uint32_t addProfileScope(Profiler &profiler, const char *name) {
+    ASSERT(profiler.scopes.size() < PROFILE_MAX_SCOPES);
+    ASSERT(!profiler.csvHeaderWritten);
+
+    ProfileScope scope;
+    scope.name = name;
+    scope.history.assign(PROFILE_HISTORY, 0.0f);
+    profiler.scopes.push_back(std::move(scope));
+    return static_cast<std::uint32_t>(profiler.scopes.size() - 1);
+}
+
+bool openProfileCsv(Profiler &profiler, const char *path) {
+    profiler.csv.open(path, std::ios::trunc);
+    if (!profiler.csv.is_open()) {
+        Log(LogLevel::ERROR, std::format("[Profiler] Could not open {}", path).c_str());
+        return false;
+    }
+    return true;
+}
+
+static void closeRow(Profiler &profiler, const ProfileRow &row) {
+    for (std::uint32_t i = 0; i < profiler.scopes.size(); ++i) {
+        if (!std::isnan(row.values[i])) {
+            ProfileScope &scope = profiler.scopes[i];
+            scope.history[scope.historyCount % PROFILE_HISTORY] = row.values[i];
+            scope.historyCount++;
+        }
+    }
+
+    if (!profiler.csv.is_open()) {
+        return;
+    }
+
+    if (!profiler.csvHeaderWritten) {
+        profiler.csv << "frame";
+        for (const ProfileScope &scope : profiler.scopes) {
+            profiler.csv << ',' << scope.name;
+        }
+        profiler.csv << '\n';
+        profiler.csvHeaderWritten = true;
+    }
+
+    profiler.csv << row.frame;
+    for (std::uint32_t i = 0; i < profiler.scopes.size(); ++i) {
+        profiler.csv << ',';
+        if (!std::isnan(row.values[i])) {
+            profiler.csv << std::format("{:.4f}", row.values[i]);
+        }
+    }
+    profiler.csv << '\n';
+}
+
+void beginProfileFrame(Profiler &profiler) {
+    if (profiler.recording) {
+        profiler.frame++;
+    }
+
+    // the slot for the new frame still holds the frame PROFILE_LATENCY ago
+    ProfileRow &row = profiler.rows[profiler.frame % PROFILE_LATENCY];
+    if (profiler.frame >= PROFILE_LATENCY) {
+        closeRow(profiler, row);
+    }
+
+    clearRow(row, profiler.frame);
+    profiler.recording = true;
+}
+
+void beginProfileScope(Profiler &profiler, std::uint32_t scope) {
+    profiler.scopes[scope].start = now();
+}
+
+void endProfileScope(Profiler &profiler, std::uint32_t scope) {
+    ProfileScope &s = profiler.scopes[scope];
+    float ms = ticksToMs(now() - s.start);
+    s.start = 0;
+
+    float &value = profiler.rows[profiler.frame % PROFILE_LATENCY].values[scope];
+    value = std::isnan(value) ? ms : value + ms;
+}
+
+void recordProfileSample(Profiler &profiler, std::uint64_t frame, std::uint32_t scope, float ms) {
+    ProfileRow &row = profiler.rows[frame % PROFILE_LATENCY];
+    if (row.frame != frame || !profiler.recording) {
+        return;
+    }
+    float &value = row.values[scope];
+    value = std::isnan(value) ? ms : value + ms;
+}
+
+void closeProfiler(Profiler &profiler) {
+    if (profiler.recording) {
+        // oldest first so the CSV stays in frame order
+        std::uint64_t first = profiler.frame >= PROFILE_LATENCY - 1
+                                  ? profiler.frame - (PROFILE_LATENCY - 1)
+                                  : 0;
+        for (std::uint64_t frame = first; frame <= profiler.frame; ++frame) {
+            closeRow(profiler, profiler.rows[frame % PROFILE_LATENCY]);
+        }
+        profiler.recording = false;
+    }
+
+    if (profiler.csv.is_open()) {
+        profiler.csv.close();
+    }
+}
+
+ProfileStats getProfileStats(const Profiler &profiler, std::uint32_t scope) {
+    const ProfileScope &s = profiler.scopes[scope];
+    std::uint32_t count = std::min(s.historyCount, PROFILE_HISTORY);
+
+    ProfileStats stats;
+    stats.samples = count;
+    if (count == 0) {
+        return stats;
+    }
+
+    std::vector<float> sorted(s.history.begin(), s.history.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+
+    float sum = 0.0f;
+    for (float value : sorted) {
+        sum += value;
+    }
+    stats.mean = sum / (float)count;
+    stats.p50 = sorted[count / 2];
+    stats.p99 = sorted[std::min(count - 1, count * 99 / 100)];
+    stats.max = sorted.back();
+    return stats;
+}
+
+void logProfileStats(const Profiler &profiler, const char *label) {
+    for (std::uint32_t i = 0; i < profiler.scopes.size(); ++i) {
+        ProfileStats stats = getProfileStats(profiler, i);
+        if (stats.samples == 0) {
+            continue;
+        }
+        Log(LogLevel::INFO,
+            std::format("[Profiler] {} {}: mean {:.3f} ms, p50 {:.3f}, p99 {:.3f}, max {:.3f} "
+                        "over the last {} frames",
+                        label, profiler.scopes[i].name, stats.mean, stats.p50, stats.p99,
+                        stats.max, stats.samples)
+                .c_str());
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Per-thread frame profiler. Code is split into named scopes, every frame gets one row with the
+// milliseconds spent in each scope (summed if a scope runs several times, like the fixed update).
+// Rows stay open for PROFILE_LATENCY frames so samples that only arrive later, GPU timer queries,
+// can still be filed under the frame they belong to. Closed rows feed the rolling statistics and
+// the optional CSV.
+
+constexpr std::uint32_t PROFILE_MAX_SCOPES = 16;
+constexpr std::uint32_t PROFILE_LATENCY = 4;
+// frames kept for the rolling statistics
+constexpr std::uint32_t PROFILE_HISTORY = 240;
+
+struct ProfileScope {
+    std::string name;
+    std::int64_t start = 0; // steady clock ticks, 0 when not inside the scope
+
+    std::vector<float> history; // ring of closed frames, PROFILE_HISTORY long
+    std::uint32_t historyCount = 0;
+};
+
+struct ProfileRow {
+    std::uint64_t frame = 0;
+    // milliseconds, NaN when the scope got no sample that frame
+    float values[PROFILE_MAX_SCOPES];
+};
+
+struct Profiler {
+    std::vector<ProfileScope> scopes;
+
+    std::uint64_t frame = 0; // the frame currently being recorded
+    bool recording = false;
+    ProfileRow rows[PROFILE_LATENCY];
+
+    std::ofstream csv;
+    bool csvHeaderWritten = false;
+};
+
+struct ProfileStats {
+    float mean = 0.0f;
+    float p50 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    std::uint32_t samples = 0;
+};
+
+std::uint32_t addProfileScope(Profiler &profiler, const char *name);
+
+// Writes a row per closed frame to `path`, returns false if it can't be opened.
+bool openProfileCsv(Profiler &profiler, const char *path);
+
+// Starts the next frame, closing the row that falls out of the latency window.
+void beginProfileFrame(Profiler &profiler);
+void beginProfileScope(Profiler &profiler, std::uint32_t scope);
+void endProfileScope(Profiler &profiler, std::uint32_t scope);
+
+// Files a sample measured elsewhere under `frame`. Dropped if that row was already closed.
+void recordProfileSample(Profiler &profiler, std::uint64_t frame, std::uint32_t scope, float ms);
+
+// Closes every open row and the CSV.
+void closeProfiler(Profiler &profiler);
+
+[[nodiscard]] ProfileStats getProfileStats(const Profiler &profiler, std::uint32_t scope);
+void logProfileStats(const Profiler &profiler, const char *label);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+
+// Small deterministic PRNG (SplitMix64). Unlike the <random> distributions its output is the same
+// on every compiler and standard library, which seeded worlds and checksums rely on.
+struct Random {
+    std::uint64_t state;
+};
+
+[[nodiscard]] constexpr Random makeRandom(std::uint64_t seed) {
+    return Random{seed};
+}
+
+[[nodiscard]] inline std::uint64_t randomNext(Random &rng) {
+    std::uint64_t z = (rng.state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+[[nodiscard]] inline float randomFloat(Random &rng) {
+    return static_cast<float>(randomNext(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+[[nodiscard]] inline float randomRange(Random &rng, float min, float max) {
+    return min + (max - min) * randomFloat(rng);
+}
+
+// Uniform in [min, max]
+[[nodiscard]] inline std::int32_t randomInt(Random &rng, std::int32_t min, std::int32_t max) {
+    std::uint64_t span = static_cast<std::uint64_t>(static_cast<std::int64_t>(max) - min) + 1;
+    return static_cast<std::int32_t>(min + static_cast<std::int64_t>(randomNext(rng) % span));
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single producer / single consumer hand-off of the latest value. The writer always has
+// a slot to fill and the reader always has a slot to read, publishing swaps the written slot with
+// the spare one, so neither side ever waits on the other and the reader only ever sees whole
+// values. Values the reader did not get to in time are dropped.
+template <typename T> struct TripleBuffer {
+    static constexpr std::uint8_t INDEX_MASK = 0x3;
+    static constexpr std::uint8_t FRESH_BIT = 0x4;
+
+    T buffers[3];
+
+    std::uint8_t writeIndex = 0;
+    std::uint8_t readIndex = 1;
+    // spare slot, FRESH_BIT is set when it holds a value the reader has not seen yet
+    std::atomic<std::uint8_t> spare{2};
+
+    // writer side
+
+    T &writeBuffer() {
+        return buffers[writeIndex];
+    }
+
+    void publish() {
+        std::uint8_t previous = spare.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // reader side
+
+    bool hasNew() const {
+        return (spare.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    // Swaps in the newest published value if there is one, returns whether it changed.
+    bool acquire() {
+        if (!hasNew()) {
+            return false;
+        }
+        std::uint8_t previous = spare.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    T &readBuffer() {
+        return buffers[readIndex];
+    }
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "commands.h"
+
+EntityId recordCreateEntity(EntityCommandBuffer &buffer, EntityManager &manager, EntityType type,
+                            Vector3 position, Vector3 scale, MeshId mesh) {
+    EntityId id = reserveEntityId(manager);
+    buffer.creates.push_back(EntityCreateCommand{id, type, position, scale, mesh});
+    return id;
+}
+
+void recordDestroyEntity(EntityCommandBuffer &buffer, EntityId id) {
+    buffer.destroys.push_back(id);
+}
+
+void applyEntityCommands(EntityCommandBuffer &buffer, EntityManager &manager,
+                         EntityChanges *changes) {
+    std::size_t newCount = manager.ids.size() + buffer.creates.size();
+    manager.ids.reserve(newCount);
+    manager.signatures.reserve(newCount);
+    manager.positions.reserve(newCount);
+    manager.velocities.reserve(newCount);
+    manager.scales.reserve(newCount);
+    manager.meshes.reserve(newCount);
+    manager.parents.reserve(newCount);
+    manager.firstChildren.reserve(newCount);
+    manager.nextSiblings.reserve(newCount);
+    manager.localTransforms.reserve(newCount);
+    manager.worldTransforms.reserve(newCount);
+    manager.transformDirty.reserve(newCount);
+
+    for (const EntityCreateCommand &command : buffer.creates) {
+        makeReservedEntity(manager, command.id, command.type);
+
+        std::uint32_t dense = manager.count() - 1;
+        manager.positions[dense] = command.position;
+        manager.scales[dense] = command.scale;
+        manager.meshes[dense] = command.mesh;
+
+        if (changes) {
+            changes->created.push_back(command.id);
+        }
+    }
+
+    // each destroy is a swap-and-pop, so despawning n entities costs O(n) in total
+    for (EntityId id : buffer.destroys) {
+        std::uint32_t dense = getEntityIndex(manager, id);
+        if (dense == ENTITY_INVALID_INDEX) {
+            continue;
+        }
+
+        if (changes) {
+            for (EntityId child = manager.firstChildren[dense]; child != ENTITY_INVALID_ID;
+                 child = manager.nextSiblings[getEntityIndex(manager, child)]) {
+                changes->reparented.push_back(child);
+            }
+            changes->destroyed.push_back(id);
+        }
+        destroyEntity(manager, id);
+    }
+
+    buffer.creates.clear();
+    buffer.destroys.clear();
+}
@@ -0,0 +1,56 @@
+#ifndef COMMANDS_H
+#define COMMANDS_H
+
+#include <vector>
+
+#include "../core/math.h"
+#include "../graphics/mesh.h"
+#include "entity.h"
+
+// Structural changes (create/destroy) recorded while systems iterate the entity columns. They are
+// applied together at a sync point between ticks, so systems never see rows move underneath them.
+
+struct EntityCreateCommand {
+    EntityId id;
+    EntityType type;
+    Vector3 position;
+    Vector3 scale;
+    MeshId mesh;
+};
+
+struct EntityCommandBuffer {
+    std::vector<EntityCreateCommand> creates;
+    std::vector<EntityId> destroys;
+
+    bool empty() const {
+        return creates.empty() && destroys.empty();
+    }
+};
+
+// What applyEntityCommands changed, for indexes kept next to the entity store.
+struct EntityChanges {
+    std::vector<EntityId> created;
+    std::vector<EntityId> destroyed;
+    // children of destroyed entities, re-rooted where they were so their positions changed
+    std::vector<EntityId> reparented;
+
+    void clear() {
+        created.clear();
+        destroyed.clear();
+        reparented.clear();
+    }
+};
+
+// The returned id is reserved immediately but only becomes alive once the buffer is applied.
+[[nodiscard]] EntityId recordCreateEntity(EntityCommandBuffer &buffer, EntityManager &manager,
+                                          EntityType type, Vector3 position,
+                                          Vector3 scale = Vector3{1, 1, 1}, MeshId mesh = 0);
+void recordDestroyEntity(EntityCommandBuffer &buffer, EntityId id);
+
+// Creates run before destroys, so an entity both created and destroyed in the same tick is
+// never observed. Duplicate or stale destroys are ignored. When `changes` is given the affected
+// ids are appended to it, an id can be both created and destroyed.
+void applyEntityCommands(EntityCommandBuffer &buffer, EntityManager &manager,
+                         EntityChanges *changes = nullptr);
+
+#endif
@@ -0,0 +1,162 @@
+#include <algorithm>
+
+#include "../core/random.h"
+#include "dungeon.h"
+
+struct ChunkResult {
+    std::vector<DungeonSpawn> spawns;
+    // corridors to the right/bottom neighbour start horizontally when set
+    bool horizontalFirst = false;
+};
+
+static Random makeChunkRandom(std::uint64_t seed, std::uint32_t chunkX, std::uint32_t chunkY) {
+    // decorrelate neighbouring chunks, the stream only depends on the seed and the position
+    Random mix = makeRandom(seed ^ (static_cast<std::uint64_t>(chunkX) << 32 | chunkY));
+    return makeRandom(randomNext(mix));
+}
+
+static std::uint32_t randomSpan(Random &rng, std::uint32_t min, std::uint32_t max) {
+    return static_cast<std::uint32_t>(
+        randomInt(rng, static_cast<std::int32_t>(min), static_cast<std::int32_t>(max)));
+}
+
+static void carve(Dungeon &dungeon, std::uint32_t x, std::uint32_t y) {
+    dungeon.tiles[y * dungeon.width + x] = TILE_FLOOR;
+}
+
+static void generateChunk(Dungeon &dungeon, const DungeonConfig &config, std::uint32_t chunkX,
+                          std::uint32_t chunkY, DungeonRoom &room, ChunkResult &result) {
+    Random rng = makeChunkRandom(config.seed, chunkX, chunkY);
+
+    std::uint32_t x0 = chunkX * config.chunkSize;
+    std::uint32_t y0 = chunkY * config.chunkSize;
+    std::uint32_t chunkWidth = std::min(config.chunkSize, dungeon.width - x0);
+    std::uint32_t chunkHeight = std::min(config.chunkSize, dungeon.height - y0);
+
+    // keep a wall ring inside the chunk so rooms in neighbouring chunks never merge
+    std::uint32_t maxWidth = chunkWidth > 2 ? chunkWidth - 2 : 1;
+    std::uint32_t maxHeight = chunkHeight > 2 ? chunkHeight - 2 : 1;
+    std::uint32_t minWidth = std::min(config.minRoomSize, maxWidth);
+    std::uint32_t minHeight = std::min(config.minRoomSize, maxHeight);
+
+    room.width = randomSpan(rng, minWidth, maxWidth);
+    room.height = randomSpan(rng, minHeight, maxHeight);
+    room.x = x0 + (chunkWidth > 2 ? 1 : 0) + randomSpan(rng, 0, maxWidth - room.width);
+    room.y = y0 + (chunkHeight > 2 ? 1 : 0) + randomSpan(rng, 0, maxHeight - room.height);
+
+    for (std::uint32_t y = room.y; y < room.y + room.height; ++y) {
+        for (std::uint32_t x = room.x; x < room.x + room.width; ++x) {
+            carve(dungeon, x, y);
+        }
+    }
+
+    std::uint32_t enemies = randomSpan(rng, 0, config.maxEnemiesPerRoom);
+    for (std::uint32_t i = 0; i < enemies; ++i) {
+        result.spawns.push_back(DungeonSpawn{randomSpan(rng, room.x, room.x + room.width - 1),
+                                             randomSpan(rng, room.y, room.y + room.height - 1),
+                                             EntityType::Enemy});
+    }
+
+    result.horizontalFirst = (randomNext(rng) & 1) != 0;
+}
+
+static void carveCorridor(Dungeon &dungeon, const DungeonRoom &from, const DungeonRoom &to,
+                          bool horizontalFirst) {
+    std::uint32_t ax = from.x + from.width / 2;
+    std::uint32_t ay = from.y + from.height / 2;
+    std::uint32_t bx = to.x + to.width / 2;
+    std::uint32_t by = to.y + to.height / 2;
+
+    // the bend sits at (bx, ay) or (ax, by)
+    std::uint32_t row = horizontalFirst ? ay : by;
+    std::uint32_t column = horizontalFirst ? bx : ax;
+
+    for (std::uint32_t x = std::min(ax, bx); x <= std::max(ax, bx); ++x) {
+        carve(dungeon, x, row);
+    }
+    for (std::uint32_t y = std::min(ay, by); y <= std::max(ay, by); ++y) {
+        carve(dungeon, column, y);
+    }
+}
+
+void generateDungeon(Dungeon &out, const DungeonConfig &config, JobSystem &jobs) {
+    out.width = config.width;
+    out.height = config.height;
+    out.tiles.assign(static_cast<std::size_t>(config.width) * config.height, TILE_WALL);
+
+    std::uint32_t chunksX = (config.width + config.chunkSize - 1) / config.chunkSize;
+    std::uint32_t chunksY = (config.height + config.chunkSize - 1) / config.chunkSize;
+    std::uint32_t chunkCount = chunksX * chunksY;
+
+    out.rooms.assign(chunkCount, DungeonRoom{});
+    std::vector<ChunkResult> results(chunkCount);
+
+    // chunks only write tiles inside their own bounds, so they can run in any order
+    parallelFor(jobs, 0, chunkCount, 1, [&](std::uint32_t begin, std::uint32_t end) {
+        for (std::uint32_t chunk = begin; chunk < end; ++chunk) {
+            generateChunk(out, config, chunk % chunksX, chunk / chunksX, out.rooms[chunk],
+                          results[chunk]);
+        }
+    });
+
+    // Corridors cross chunk borders, carve them in chunk order afterwards. Linking every room to
+    // its right and bottom neighbour keeps the whole floor connected.
+    for (std::uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+        std::uint32_t chunkX = chunk % chunksX;
+        std::uint32_t chunkY = chunk / chunksX;
+        bool horizontalFirst = results[chunk].horizontalFirst;
+
+        if (chunkX + 1 < chunksX) {
+            carveCorridor(out, out.rooms[chunk], out.rooms[chunk + 1], horizontalFirst);
+        }
+        if (chunkY + 1 < chunksY) {
+            carveCorridor(out, out.rooms[chunk], out.rooms[chunk + chunksX], horizontalFirst);
+        }
+    }
+
+    out.spawns.clear();
+    const DungeonRoom &start = out.rooms[0];
+    out.spawns.push_back(DungeonSpawn{start.x + start.width / 2, start.y + start.height / 2,
+                                      EntityType::Player});
+
+    // the starting room stays empty
+    for (std::uint32_t chunk = 1; chunk < chunkCount; ++chunk) {
+        out.spawns.insert(out.spawns.end(), results[chunk].spawns.begin(),
+                          results[chunk].spawns.end());
+    }
+}
+
+std::uint64_t checksumDungeon(const Dungeon &dungeon) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    auto mix = [&](std::uint64_t value) {
+        hash ^= value;
+        hash *= 0x100000001B3ull;
+    };
+
+    for (std::uint8_t tile : dungeon.tiles) {
+        mix(tile);
+    }
+    for (const DungeonSpawn &spawn : dungeon.spawns) {
+        mix(spawn.x);
+        mix(spawn.y);
+        mix(spawn.type);
+    }
+    return hash;
+}
+
+EntityId spawnDungeon(const Dungeon &dungeon, EntityManager &manager, MeshId actorMesh) {
+    EntityId player = ENTITY_INVALID_ID;
+    for (const DungeonSpawn &spawn : dungeon.spawns) {
+        EntityId id = makeEntity(manager, spawn.type);
+        std::uint32_t dense = getEntityIndex(manager, id);
+        manager.positions[dense] =
+            Vector3{static_cast<float>(spawn.x), 0, static_cast<float>(spawn.y)};
+        manager.meshes[dense] = actorMesh;
+
+        if (spawn.type == EntityType::Player) {
+            player = id;
+        }
+    }
+
+    return player;
+}
@@ -0,0 +1,65 @@
+#ifndef DUNGEON_H
+#define DUNGEON_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/jobs.h"
+#include "../graphics/mesh.h"
+#include "entity.h"
+
+// Procedural dungeon floors. The map is split into square chunks that are generated independently
+// (one room per chunk, each chunk with its own RNG stream derived from the seed), so chunks run in
+// parallel and the result is identical for a given seed no matter how many workers there are.
+// One tile is one world unit, tile (x, y) covers [x, x + 1] x [y, y + 1] on the XZ plane.
+
+enum Tile : std::uint8_t {
+    TILE_WALL,
+    TILE_FLOOR,
+};
+
+struct DungeonConfig {
+    std::uint32_t width = 512;
+    std::uint32_t height = 512;
+    std::uint32_t chunkSize = 32;
+    std::uint64_t seed = 1;
+
+    std::uint32_t minRoomSize = 6;
+    std::uint32_t maxEnemiesPerRoom = 4;
+};
+
+struct DungeonRoom {
+    std::uint32_t x, y;
+    std::uint32_t width, height;
+};
+
+struct DungeonSpawn {
+    std::uint32_t x, y;
+    EntityType type;
+};
+
+struct Dungeon {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> tiles; // row-major, Tile values
+
+    // one per chunk, in chunk order
+    std::vector<DungeonRoom> rooms;
+    // first entry is the player
+    std::vector<DungeonSpawn> spawns;
+
+    Tile at(std::uint32_t x, std::uint32_t y) const {
+        return static_cast<Tile>(tiles[y * width + x]);
+    }
+};
+
+void generateDungeon(Dungeon &out, const DungeonConfig &config, JobSystem &jobs);
+
+// Hash of the tiles and spawns, for checking determinism.
+[[nodiscard]] std::uint64_t checksumDungeon(const Dungeon &dungeon);
+
+// Spawns the player and the enemies, returns the player. The map itself is drawn by the chunk
+// meshes of dungeon_mesh.h.
+EntityId spawnDungeon(const Dungeon &dungeon, EntityManager &manager, MeshId actorMesh);
+
+#endif
@@ -0,0 +1,12 @@
+#include "dungeon_edit.h"
+
+void editDungeonTile(Dungeon &dungeon, FlowField &flowField, FieldOfView &fov,
+                     DungeonMesher &mesher, std::uint32_t x, std::uint32_t y, Tile tile) {
+    if (dungeon.at(x, y) == tile) {
+        return;
+    }
+
+    setDungeonTile(flowField, dungeon, x, y, tile);
+    invalidateFieldOfView(fov, x, y);
+    markDungeonTileDirty(mesher, x, y);
+}
@@ -0,0 +1,18 @@
+#ifndef DUNGEON_EDIT_H
+#define DUNGEON_EDIT_H
+
+#include <cstdint>
+
+#include "dungeon.h"
+#include "dungeon_mesh.h"
+#include "fov.h"
+#include "pathfinding.h"
+
+// The one way to change a tile while the game runs, keeps everything derived from the tiles in
+// step: repairs the flow field, marks the field of view for recasting if the viewer could see the
+// tile, and marks the chunks around it dirty so the next remeshDirtyChunks rebuilds them in the
+// background.
+void editDungeonTile(Dungeon &dungeon, FlowField &flowField, FieldOfView &fov,
+                     DungeonMesher &mesher, std::uint32_t x, std::uint32_t y, Tile tile);
+
+#endif
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <utility>
+
+#include "../core/logger.h"
+#include "dungeon_mesh.h"
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Appends the quad p, p + b, p + a + b, p + a, counter-clockwise seen from `normal`. UVs are the
+// world coordinates in the plane of the face, one repeat per tile.
+static void addQuad(std::vector<Vertex> &vertices, std::vector<unsigned int> &indices,
+                    Vector3 p, Vector3 a, Vector3 b, Vector3 normal) {
+    unsigned int base = static_cast<unsigned int>(vertices.size());
+    Vector3 corners[4] = {p, p + b, p + a + b, p + a};
+    for (const Vector3 &c : corners) {
+        float u = normal.x != 0 ? c.z : c.x;
+        float v = normal.y != 0 ? c.z : c.y;
+        vertices.push_back(Vertex{c.x, c.y, c.z, normal.x, normal.y, normal.z, u, v});
+    }
+    indices.insert(indices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+}
+
+// Greedy meshing of the tops of every `tile` in the chunk: grow a run along x, then grow it along
+// y while the whole next row matches, emit it as one quad and mark it used.
+static void addTops(const DungeonChunkTiles &chunk, Tile tile, float y, std::vector<bool> &used,
+                    std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    int width = static_cast<int>(chunk.width);
+    int height = static_cast<int>(chunk.height);
+    std::fill(used.begin(), used.end(), false);
+
+    auto open = [&](int x, int z) {
+        return chunk.at(x, z) == tile && !used[(std::size_t)z * chunk.width + (std::size_t)x];
+    };
+
+    for (int z = 0; z < height; ++z) {
+        for (int x = 0; x < width; ++x) {
+            if (!open(x, z)) {
+                continue;
+            }
+
+            int w = 1;
+            while (x + w < width && open(x + w, z)) {
+                ++w;
+            }
+
+            int h = 1;
+            while (z + h < height) {
+                bool row = true;
+                for (int i = 0; i < w && row; ++i) {
+                    row = open(x + i, z + h);
+                }
+                if (!row) {
+                    break;
+                }
+                ++h;
+            }
+
+            for (int dz = 0; dz < h; ++dz) {
+                for (int dx = 0; dx < w; ++dx) {
+                    used[(std::size_t)(z + dz) * chunk.width + (std::size_t)(x + dx)] = true;
+                }
+            }
+
+            Vector3 p{(float)chunk.x0 + (float)x, y, (float)chunk.y0 + (float)z};
+            addQuad(vertices, indices, p, Vector3{(float)w, 0, 0}, Vector3{0, 0, (float)h},
+                    Vector3{0, 1, 0});
+        }
+    }
+}
+
+// A wall tile at (x, z) gets a side towards (x + dx, z + dz) only if that tile is floor, faces
+// between walls are never visible. Sides are merged along the wall into runs.
+static void addSides(const DungeonChunkTiles &chunk, int dx, int dz,
+                     std::vector<Vertex> &vertices, std::vector<unsigned int> &indices) {
+    // the axis the faces run along, x for faces looking along z and the other way around
+    bool alongX = dx == 0;
+    int lines = static_cast<int>(alongX ? chunk.height : chunk.width);
+    int length = static_cast<int>(alongX ? chunk.width : chunk.height);
+
+    auto faces = [&](int line, int i) {
+        int x = alongX ? i : line;
+        int z = alongX ? line : i;
+        return chunk.at(x, z) == TILE_WALL && chunk.at(x + dx, z + dz) == TILE_FLOOR;
+    };
+
+    const float H = DUNGEON_WALL_HEIGHT;
+    Vector3 normal{(float)dx, 0, (float)dz};
+
+    for (int line = 0; line < lines; ++line) {
+        int i = 0;
+        while (i < length) {
+            if (!faces(line, i)) {
+                ++i;
+                continue;
+            }
+
+            int start = i;
+            while (i < length && faces(line, i)) {
+                ++i;
+            }
+            float run = (float)(i - start);
+
+            // the face lies on the tile edge towards the floor
+            float x = (float)chunk.x0 + (float)(alongX ? start : line + std::max(dx, 0));
+            float z = (float)chunk.y0 + (float)(alongX ? line + std::max(dz, 0) : start);
+            Vector3 p{x, 0, z};
+
+            if (dx < 0) {
+                addQuad(vertices, indices, p, Vector3{0, H, 0}, Vector3{0, 0, run}, normal);
+            } else if (dx > 0) {
+                addQuad(vertices, indices, p, Vector3{0, 0, run}, Vector3{0, H, 0}, normal);
+            } else if (dz < 0) {
+                addQuad(vertices, indices, p, Vector3{run, 0, 0}, Vector3{0, H, 0}, normal);
+            } else {
+                addQuad(vertices, indices, p, Vector3{0, H, 0}, Vector3{run, 0, 0}, normal);
+            }
+        }
+    }
+}
+
+void initDungeonMesher(DungeonMesher &mesher, const Dungeon &dungeon, std::uint32_t chunkSize) {
+    mesher.chunkSize = chunkSize;
+    mesher.chunksX = (dungeon.width + chunkSize - 1) / chunkSize;
+    mesher.chunksY = (dungeon.height + chunkSize - 1) / chunkSize;
+    mesher.chunks.assign((std::size_t)mesher.chunksX * mesher.chunksY, DungeonChunkMesh{});
+}
+
+void copyDungeonChunk(const Dungeon &dungeon, const DungeonMesher &mesher, std::uint32_t chunk,
+                      DungeonChunkTiles &out) {
+    out.x0 = (chunk % mesher.chunksX) * mesher.chunkSize;
+    out.y0 = (chunk / mesher.chunksX) * mesher.chunkSize;
+    out.width = std::min(mesher.chunkSize, dungeon.width - out.x0);
+    out.height = std::min(mesher.chunkSize, dungeon.height - out.y0);
+    out.tiles.assign((std::size_t)(out.width + 2) * (out.height + 2), TILE_WALL);
+
+    for (std::uint32_t y = 0; y < out.height + 2; ++y) {
+        std::int64_t mapY = (std::int64_t)out.y0 + y - 1;
+        if (mapY < 0 || mapY >= dungeon.height) {
+            continue;
+        }
+        for (std::uint32_t x = 0; x < out.width + 2; ++x) {
+            std::int64_t mapX = (std::int64_t)out.x0 + x - 1;
+            if (mapX < 0 || mapX >= dungeon.width) {
+                continue;
+            }
+            out.tiles[(std::size_t)y * (out.width + 2) + x] =
+                dungeon.at((std::uint32_t)mapX, (std::uint32_t)mapY);
+        }
+    }
+}
+
+void buildDungeonChunkGeometry(const DungeonChunkTiles &chunk, std::vector<Vertex> &vertices,
+                               std::vector<unsigned int> &indices) {
+    vertices.clear();
+    indices.clear();
+
+    std::vector<bool> used((std::size_t)chunk.width * chunk.height);
+    addTops(chunk, TILE_FLOOR, 0.0f, used, vertices, indices);
+    addTops(chunk, TILE_WALL, DUNGEON_WALL_HEIGHT, used, vertices, indices);
+
+    addSides(chunk, -1, 0, vertices, indices);
+    addSides(chunk, 1, 0, vertices, indices);
+    addSides(chunk, 0, -1, vertices, indices);
+    addSides(chunk, 0, 1, vertices, indices);
+}
+
+void meshDungeon(DungeonMesher &mesher, const Dungeon &dungeon, EntityManager &manager,
+                 MeshRegistry &registry, JobSystem &jobs) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::uint32_t count = static_cast<std::uint32_t>(mesher.chunks.size());
+    std::vector<std::vector<Vertex>> vertices(count);
+    std::vector<std::vector<unsigned int>> indices(count);
+    parallelFor(jobs, 0, count, 1, [&](std::uint32_t begin, std::uint32_t end) {
+        DungeonChunkTiles tiles;
+        for (std::uint32_t chunk = begin; chunk < end; ++chunk) {
+            auto chunkStart = std::chrono::steady_clock::now();
+            copyDungeonChunk(dungeon, mesher, chunk, tiles);
+            buildDungeonChunkGeometry(tiles, vertices[chunk], indices[chunk]);
+
+            DungeonChunkMesh &mesh = mesher.chunks[chunk];
+            mesh.triangles = static_cast<std::uint32_t>(indices[chunk].size() / 3);
+            mesh.buildMs = (float)elapsedMs(chunkStart);
+            mesh.builds = 1;
+        }
+    });
+
+    // uploads stay on this thread, it has the context
+    std::uint64_t triangles = 0;
+    for (std::uint32_t chunk = 0; chunk < count; ++chunk) {
+        DungeonChunkMesh &mesh = mesher.chunks[chunk];
+        mesh.mesh =
+            makeMesh(registry, vertices[chunk].data(),
+                     static_cast<unsigned int>(vertices[chunk].size()), indices[chunk].data(),
+                     static_cast<unsigned int>(indices[chunk].size()));
+        triangles += mesh.triangles;
+
+        Log(LogLevel::DEBUG,
+            std::format("[Dungeon] Meshed chunk {} ({}, {}): {} triangles in {:.3f} ms", chunk,
+                        chunk % mesher.chunksX, chunk / mesher.chunksX, mesh.triangles,
+                        mesh.buildMs)
+                .c_str());
+
+        // chunk geometry is in world space
+        EntityId prop = makeEntity(manager, EntityType::Prop);
+        manager.meshes[getEntityIndex(manager, prop)] = mesh.mesh;
+    }
+
+    Log(LogLevel::INFO, std::format("[Dungeon] Meshed {} chunks: {} triangles in {:.2f} ms", count,
+                                    triangles, elapsedMs(start))
+                            .c_str());
+}
+
+void markDungeonTileDirty(DungeonMesher &mesher, std::uint32_t x, std::uint32_t y) {
+    std::lock_guard<std::mutex> lock(mesher.mutex);
+
+    std::uint32_t chunkX = x / mesher.chunkSize;
+    std::uint32_t chunkY = y / mesher.chunkSize;
+    mesher.chunks[(std::size_t)chunkY * mesher.chunksX + chunkX].dirty = true;
+
+    // a chunk's border tiles decide which wall sides its neighbour emits
+    const int offsets[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    for (const auto &offset : offsets) {
+        std::int64_t nx = ((std::int64_t)x + offset[0]) / mesher.chunkSize;
+        std::int64_t ny = ((std::int64_t)y + offset[1]) / mesher.chunkSize;
+        if ((std::int64_t)x + offset[0] < 0 || (std::int64_t)y + offset[1] < 0 ||
+            nx >= mesher.chunksX || ny >= mesher.chunksY) {
+            continue;
+        }
+        mesher.chunks[(std::size_t)ny * mesher.chunksX + (std::size_t)nx].dirty = true;
+    }
+}
+
+void remeshDirtyChunks(DungeonMesher &mesher, const Dungeon &dungeon, JobSystem &jobs,
+                       MeshUploadQueue &uploads) {
+    std::lock_guard<std::mutex> lock(mesher.mutex);
+
+    for (std::uint32_t chunk = 0; chunk < mesher.chunks.size(); ++chunk) {
+        DungeonChunkMesh &mesh = mesher.chunks[chunk];
+        if (!mesh.dirty || mesh.building) {
+            continue;
+        }
+        mesh.dirty = false;
+        mesh.building = true;
+
+        // copied here so the job never reads tiles the caller is still changing
+        DungeonChunkTiles tiles;
+        copyDungeonChunk(dungeon, mesher, chunk, tiles);
+
+        submitJob(
+            jobs,
+            [&mesher, &uploads, chunk, tiles = std::move(tiles)] {
+                auto start = std::chrono::steady_clock::now();
+
+                MeshUpload upload;
+                buildDungeonChunkGeometry(tiles, upload.vertices, upload.indices);
+                std::uint32_t triangles = static_cast<std::uint32_t>(upload.indices.size() / 3);
+                float ms = (float)elapsedMs(start);
+
+                std::lock_guard<std::mutex> lock(mesher.mutex);
+                DungeonChunkMesh &mesh = mesher.chunks[chunk];
+                upload.mesh = mesh.mesh;
+                pushMeshUpload(uploads, std::move(upload));
+
+                mesh.triangles = triangles;
+                mesh.buildMs = ms;
+                mesh.builds++;
+                mesh.building = false;
+
+                Log(LogLevel::DEBUG,
+                    std::format("[Dungeon] Remeshed chunk {} ({}, {}): {} triangles in {:.3f} ms",
+                                chunk, tiles.x0 / mesher.chunkSize, tiles.y0 / mesher.chunkSize,
+                                triangles, ms)
+                        .c_str());
+            },
+            &mesher.building);
+    }
+}
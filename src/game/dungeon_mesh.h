@@ -0,0 +1,79 @@
+#ifndef DUNGEON_MESH_H
+#define DUNGEON_MESH_H
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "../core/jobs.h"
+#include "../graphics/mesh.h"
+#include "dungeon.h"
+#include "entity.h"
+
+// Renders the dungeon as one mesh per chunk. Coplanar faces are merged with greedy meshing: floor
+// tops at y = 0, wall tops at DUNGEON_WALL_HEIGHT, and wall sides only where a wall faces a floor
+// tile, so faces between two walls are never emitted. Edited chunks are remeshed by a job and
+// handed to the render thread through a MeshUploadQueue, the mesh ids never change.
+
+constexpr float DUNGEON_WALL_HEIGHT = 1.0f;
+
+// The tiles of one chunk plus a one tile border, copied so a job can mesh the chunk while the
+// dungeon keeps changing. Tiles outside the map count as walls.
+struct DungeonChunkTiles {
+    std::uint32_t x0 = 0; // first tile of the chunk
+    std::uint32_t y0 = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> tiles; // (width + 2) x (height + 2), row-major
+
+    // local coordinates, -1 and width/height are the border
+    Tile at(int x, int y) const {
+        return static_cast<Tile>(tiles[(std::size_t)(y + 1) * (width + 2) + (std::size_t)(x + 1)]);
+    }
+};
+
+struct DungeonChunkMesh {
+    MeshId mesh = MESH_INVALID_ID;
+    bool dirty = false;
+    bool building = false;
+
+    // last build
+    std::uint32_t triangles = 0;
+    float buildMs = 0.0f;
+    std::uint32_t builds = 0;
+};
+
+struct DungeonMesher {
+    std::uint32_t chunkSize = 32;
+    std::uint32_t chunksX = 0;
+    std::uint32_t chunksY = 0;
+
+    // guards the chunks while remesh jobs are running
+    std::mutex mutex;
+    std::vector<DungeonChunkMesh> chunks;
+    // remesh jobs in flight
+    JobCounter building;
+};
+
+void initDungeonMesher(DungeonMesher &mesher, const Dungeon &dungeon, std::uint32_t chunkSize);
+
+void copyDungeonChunk(const Dungeon &dungeon, const DungeonMesher &mesher, std::uint32_t chunk,
+                      DungeonChunkTiles &out);
+void buildDungeonChunkGeometry(const DungeonChunkTiles &chunk, std::vector<Vertex> &vertices,
+                               std::vector<unsigned int> &indices);
+
+// Meshes every chunk across the workers, uploads them and spawns one prop per chunk. Needs the GL
+// context.
+void meshDungeon(DungeonMesher &mesher, const Dungeon &dungeon, EntityManager &manager,
+                 MeshRegistry &registry, JobSystem &jobs);
+
+// Call after tile (x, y) changed. Marks its chunk, and the chunks next to it when the tile is on
+// a chunk edge since their wall sides may face it.
+void markDungeonTileDirty(DungeonMesher &mesher, std::uint32_t x, std::uint32_t y);
+
+// Starts a job for every dirty chunk that isn't already being rebuilt, the finished geometry is
+// pushed to `uploads`. Chunks edited again while building are picked up by the next call.
+void remeshDirtyChunks(DungeonMesher &mesher, const Dungeon &dungeon, JobSystem &jobs,
+                       MeshUploadQueue &uploads);
+
+#endif
@@ -1,5 +1,6 @@
 #include <algorithm>
 
+#include "../core/assert.h"
 #include "entity.h"
 
 const std::string getEntityTypeStr(const EntityType type) {
@@ -8,60 +9,391 @@ const std::string getEntityTypeStr(const EntityType type) {
         return "Player";
     case EntityType::Enemy:
         return "Enemy";
+    case EntityType::Prop:
+        return "Prop";
     default:
         return "ENTITY";
     }
 }
 
-Entity *makeEntity(EntityManager &manager, EntityType type) {
-    Entity *e = new Entity{};
+ComponentMask getEntityTypeSignature(EntityType type) {
+    ComponentMask base = componentBit(COMPONENT_TRANSFORM) | componentBit(COMPONENT_VELOCITY) |
+                         componentBit(COMPONENT_MESH);
+    switch (type) {
+    case EntityType::Player:
+        return base | componentBit(COMPONENT_PLAYER);
+    case EntityType::Enemy:
+        return base | componentBit(COMPONENT_ENEMY);
+    case EntityType::Prop:
+        return componentBit(COMPONENT_TRANSFORM) | componentBit(COMPONENT_MESH);
+    default:
+        return base;
+    }
+}
+
+static void queryAdd(EntityQuery &query, std::uint32_t dense) {
+    query.slots[dense] = query.count();
+    query.dense.push_back(dense);
+}
+
+static void queryRemove(EntityQuery &query, std::uint32_t dense) {
+    std::uint32_t slot = query.slots[dense];
+    std::uint32_t moved = query.dense.back();
+
+    query.dense[slot] = moved;
+    query.slots[moved] = slot;
+    query.dense.pop_back();
+    query.slots[dense] = ENTITY_INVALID_INDEX;
+}
 
-    e->id = manager.currentId++;
-    e->type = type;
-    e->position = Vector3{0, 0, 0};
+EntityId reserveEntityId(EntityManager &manager) {
+    std::uint32_t index;
+    if (!manager.freeIndices.empty()) {
+        index = manager.freeIndices.back();
+        manager.freeIndices.pop_back();
+    } else {
+        index = static_cast<std::uint32_t>(manager.denseIndex.size());
+        ASSERT(index < ENTITY_MAX_COUNT);
+        manager.denseIndex.push_back(ENTITY_INVALID_INDEX);
+        manager.generations.push_back(0);
+    }
+
+    return makeEntityId(index, manager.generations[index]);
+}
 
-    manager.entities.push_back(e);
-    manager.entityMap[e->id] = e;
-    manager.entityTypeMap[type].push_back(e);
+void makeReservedEntity(EntityManager &manager, EntityId id, EntityType type) {
+    std::uint32_t index = entityIdIndex(id);
+    ASSERT(manager.generations[index] == entityIdGeneration(id));
+    ASSERT(manager.denseIndex[index] == ENTITY_INVALID_INDEX);
 
-    return e;
+    std::uint32_t dense = manager.count();
+    ComponentMask signature = getEntityTypeSignature(type);
+
+    manager.denseIndex[index] = dense;
+    manager.ids.push_back(id);
+    manager.signatures.push_back(signature);
+    manager.positions.push_back(Vector3{0, 0, 0});
+    manager.velocities.push_back(Vector3{0, 0, 0});
+    manager.scales.push_back(Vector3{1, 1, 1});
+    manager.meshes.push_back(0);
+    manager.parents.push_back(ENTITY_INVALID_ID);
+    manager.firstChildren.push_back(ENTITY_INVALID_ID);
+    manager.nextSiblings.push_back(ENTITY_INVALID_ID);
+    manager.localTransforms.push_back(mat4_identity());
+    manager.worldTransforms.push_back(mat4_identity());
+    manager.transformDirty.push_back(0);
+    markTransformDirty(manager, dense);
+
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        query->slots.push_back(ENTITY_INVALID_INDEX);
+        if (query->matches(signature)) {
+            queryAdd(*query, dense);
+        }
+    }
+}
+
+EntityId makeEntity(EntityManager &manager, EntityType type) {
+    EntityId id = reserveEntityId(manager);
+    makeReservedEntity(manager, id, type);
+    return id;
+}
+
+// Takes `dense` out of its parent's child list, it becomes a root.
+static void unlinkParent(EntityManager &manager, std::uint32_t dense) {
+    std::uint32_t parent = getEntityIndex(manager, manager.parents[dense]);
+    manager.parents[dense] = ENTITY_INVALID_ID;
+    if (parent == ENTITY_INVALID_INDEX) {
+        return;
+    }
+
+    EntityId id = manager.ids[dense];
+    EntityId *link = &manager.firstChildren[parent];
+    while (*link != id) {
+        ASSERT(*link != ENTITY_INVALID_ID);
+        link = &manager.nextSiblings[getEntityIndex(manager, *link)];
+    }
+    *link = manager.nextSiblings[dense];
+    manager.nextSiblings[dense] = ENTITY_INVALID_ID;
+}
+
+// The world transform of `dense` built from the positions and scales up its parent chain, not
+// the cache, which is stale for anything moved since the last updateTransforms.
+static Mat4 currentWorldTransform(const EntityManager &manager, std::uint32_t dense) {
+    Mat4 world = mat4_identity();
+    for (std::uint32_t row = dense; row != ENTITY_INVALID_INDEX;
+         row = getEntityIndex(manager, manager.parents[row])) {
+        world = mat4_translate(manager.positions[row]) * mat4_scale(manager.scales[row]) * world;
+    }
+    return world;
 }
 
 void destroyEntity(EntityManager &manager, EntityId id) {
-    auto it = manager.entityMap.find(id);
-    if (it == manager.entityMap.end())
+    std::uint32_t dense = getEntityIndex(manager, id);
+    if (dense == ENTITY_INVALID_INDEX) {
         return;
+    }
+
+    // the children become roots where they are in the world, transforms are only ever translate
+    // and scale so the world matrix splits back into the two
+    Mat4 parentWorld = currentWorldTransform(manager, dense);
+    unlinkParent(manager, dense);
+    EntityId child = manager.firstChildren[dense];
+    while (child != ENTITY_INVALID_ID) {
+        std::uint32_t row = getEntityIndex(manager, child);
+        child = manager.nextSiblings[row];
 
-    Entity *e = it->second;
+        Mat4 world =
+            parentWorld * mat4_translate(manager.positions[row]) * mat4_scale(manager.scales[row]);
+        manager.positions[row] = Vector3{world[0][3], world[1][3], world[2][3]};
+        manager.scales[row] = Vector3{world[0][0], world[1][1], world[2][2]};
+        manager.parents[row] = ENTITY_INVALID_ID;
+        manager.nextSiblings[row] = ENTITY_INVALID_ID;
+        markTransformDirty(manager, row);
+    }
 
-    auto vit = std::find(manager.entities.begin(), manager.entities.end(), e);
-    if (vit != manager.entities.end())
-        manager.entities.erase(vit);
+    std::uint32_t last = manager.count() - 1;
 
-    auto &tv = manager.entityTypeMap[e->type];
-    auto tit = std::find(tv.begin(), tv.end(), e);
-    if (tit != tv.end())
-        tv.erase(tit);
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        if (query->slots[dense] != ENTITY_INVALID_INDEX) {
+            queryRemove(*query, dense);
+        }
+
+        // the last row is about to move into `dense`
+        std::uint32_t slot = query->slots[last];
+        if (dense != last && slot != ENTITY_INVALID_INDEX) {
+            query->dense[slot] = dense;
+            query->slots[dense] = slot;
+        }
+        query->slots.pop_back();
+    }
 
-    manager.entityMap.erase(it);
-    delete e;
+    // swap-and-pop: the last row takes over the hole so the columns stay packed
+    if (dense != last) {
+        EntityId movedId = manager.ids[last];
+
+        manager.ids[dense] = movedId;
+        manager.signatures[dense] = manager.signatures[last];
+        manager.positions[dense] = manager.positions[last];
+        manager.velocities[dense] = manager.velocities[last];
+        manager.scales[dense] = manager.scales[last];
+        manager.meshes[dense] = manager.meshes[last];
+        manager.parents[dense] = manager.parents[last];
+        manager.firstChildren[dense] = manager.firstChildren[last];
+        manager.nextSiblings[dense] = manager.nextSiblings[last];
+        manager.localTransforms[dense] = manager.localTransforms[last];
+        manager.worldTransforms[dense] = manager.worldTransforms[last];
+        manager.transformDirty[dense] = manager.transformDirty[last];
+
+        manager.denseIndex[entityIdIndex(movedId)] = dense;
+    }
+
+    manager.ids.pop_back();
+    manager.signatures.pop_back();
+    manager.positions.pop_back();
+    manager.velocities.pop_back();
+    manager.scales.pop_back();
+    manager.meshes.pop_back();
+    manager.parents.pop_back();
+    manager.firstChildren.pop_back();
+    manager.nextSiblings.pop_back();
+    manager.localTransforms.pop_back();
+    manager.worldTransforms.pop_back();
+    manager.transformDirty.pop_back();
+
+    std::uint32_t index = entityIdIndex(id);
+    manager.denseIndex[index] = ENTITY_INVALID_INDEX;
+    manager.generations[index] = (manager.generations[index] + 1) & ENTITY_GENERATION_MASK;
+    manager.freeIndices.push_back(index);
 }
 
 void destroyAllEntities(EntityManager &manager) {
-    for (Entity *entity : manager.entities) {
-        delete entity;
+    for (EntityId id : manager.ids) {
+        std::uint32_t index = entityIdIndex(id);
+        manager.denseIndex[index] = ENTITY_INVALID_INDEX;
+        manager.generations[index] = (manager.generations[index] + 1) & ENTITY_GENERATION_MASK;
+        manager.freeIndices.push_back(index);
+    }
+
+    manager.ids.clear();
+    manager.signatures.clear();
+    manager.positions.clear();
+    manager.velocities.clear();
+    manager.scales.clear();
+    manager.meshes.clear();
+    manager.parents.clear();
+    manager.firstChildren.clear();
+    manager.nextSiblings.clear();
+    manager.localTransforms.clear();
+    manager.worldTransforms.clear();
+    manager.transformDirty.clear();
+    manager.dirtyTransforms.clear();
+
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        query->dense.clear();
+        query->slots.clear();
+    }
+}
+
+bool isEntityAlive(const EntityManager &manager, EntityId id) {
+    return getEntityIndex(manager, id) != ENTITY_INVALID_INDEX;
+}
+
+std::uint32_t getEntityIndex(const EntityManager &manager, EntityId id) {
+    std::uint32_t index = entityIdIndex(id);
+    if (index >= manager.denseIndex.size()) {
+        return ENTITY_INVALID_INDEX;
+    }
+    if (manager.generations[index] != entityIdGeneration(id)) {
+        return ENTITY_INVALID_INDEX;
+    }
+    return manager.denseIndex[index];
+}
+
+bool hasComponent(const EntityManager &manager, EntityId id, ComponentType component) {
+    std::uint32_t dense = getEntityIndex(manager, id);
+    if (dense == ENTITY_INVALID_INDEX) {
+        return false;
+    }
+    return (manager.signatures[dense] & componentBit(component)) != 0;
+}
+
+static void setSignature(EntityManager &manager, std::uint32_t dense, ComponentMask signature) {
+    ComponentMask previous = manager.signatures[dense];
+    manager.signatures[dense] = signature;
+
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        bool before = query->matches(previous);
+        bool after = query->matches(signature);
+        if (!before && after) {
+            queryAdd(*query, dense);
+        } else if (before && !after) {
+            queryRemove(*query, dense);
+        }
     }
+}
 
-    manager.entities.clear();
-    manager.entityMap.clear();
-    manager.entityTypeMap.clear();
+void addComponent(EntityManager &manager, EntityId id, ComponentType component) {
+    std::uint32_t dense = getEntityIndex(manager, id);
+    if (dense == ENTITY_INVALID_INDEX) {
+        return;
+    }
+    setSignature(manager, dense, manager.signatures[dense] | componentBit(component));
 }
 
-Entity *getEntityById(const EntityManager &manager, EntityId id) {
-    auto it = manager.entityMap.find(id);
-    return (it == manager.entityMap.end()) ? nullptr : it->second;
+void removeComponent(EntityManager &manager, EntityId id, ComponentType component) {
+    std::uint32_t dense = getEntityIndex(manager, id);
+    if (dense == ENTITY_INVALID_INDEX) {
+        return;
+    }
+    setSignature(manager, dense, manager.signatures[dense] & ~componentBit(component));
 }
 
-std::vector<Entity *> *getEntitiesByTag(EntityManager &manager, EntityType type) {
-    return &manager.entityTypeMap[type];
+void markTransformDirty(EntityManager &manager, std::uint32_t dense) {
+    if (!manager.transformDirty[dense]) {
+        manager.transformDirty[dense] = 1;
+        manager.dirtyTransforms.push_back(manager.ids[dense]);
+    }
+}
+
+bool setParent(EntityManager &manager, EntityId child, EntityId parent) {
+    std::uint32_t dense = getEntityIndex(manager, child);
+    if (dense == ENTITY_INVALID_INDEX) {
+        return false;
+    }
+
+    std::uint32_t parentDense = ENTITY_INVALID_INDEX;
+    if (parent != ENTITY_INVALID_ID) {
+        parentDense = getEntityIndex(manager, parent);
+        if (parentDense == ENTITY_INVALID_INDEX) {
+            return false;
+        }
+        // walking up from the new parent must not reach the child
+        for (EntityId ancestor = parent; ancestor != ENTITY_INVALID_ID;
+             ancestor = manager.parents[getEntityIndex(manager, ancestor)]) {
+            if (ancestor == child) {
+                return false;
+            }
+        }
+    }
+
+    unlinkParent(manager, dense);
+    if (parentDense != ENTITY_INVALID_INDEX) {
+        manager.parents[dense] = parent;
+        manager.nextSiblings[dense] = manager.firstChildren[parentDense];
+        manager.firstChildren[parentDense] = child;
+    }
+
+    markTransformDirty(manager, dense);
+    return true;
+}
+
+EntityQuery *registerQuery(EntityManager &manager, ComponentMask all, ComponentMask none) {
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        if (query->all == all && query->none == none) {
+            return query.get();
+        }
+    }
+
+    std::unique_ptr<EntityQuery> query = std::make_unique<EntityQuery>();
+    query->all = all;
+    query->none = none;
+    query->slots.assign(manager.count(), ENTITY_INVALID_INDEX);
+
+    for (std::uint32_t dense = 0; dense < manager.count(); ++dense) {
+        if (query->matches(manager.signatures[dense])) {
+            queryAdd(*query, dense);
+        }
+    }
+
+    manager.queries.push_back(std::move(query));
+    return manager.queries.back().get();
+}
+
+void rebuildEntityIndex(EntityManager &manager) {
+    std::fill(manager.denseIndex.begin(), manager.denseIndex.end(), ENTITY_INVALID_INDEX);
+    for (std::uint32_t dense = 0; dense < manager.count(); ++dense) {
+        std::uint32_t index = entityIdIndex(manager.ids[dense]);
+        ASSERT(index < manager.denseIndex.size());
+        manager.denseIndex[index] = dense;
+    }
+
+    manager.freeIndices.clear();
+    for (std::uint32_t index = static_cast<std::uint32_t>(manager.denseIndex.size()); index > 0;
+         --index) {
+        if (manager.denseIndex[index - 1] == ENTITY_INVALID_INDEX) {
+            manager.freeIndices.push_back(index - 1);
+        }
+    }
+
+    std::uint32_t count = manager.count();
+    manager.parents.resize(count, ENTITY_INVALID_ID);
+    manager.firstChildren.assign(count, ENTITY_INVALID_ID);
+    manager.nextSiblings.assign(count, ENTITY_INVALID_ID);
+    for (std::uint32_t dense = 0; dense < count; ++dense) {
+        std::uint32_t parent = getEntityIndex(manager, manager.parents[dense]);
+        if (parent == ENTITY_INVALID_INDEX) {
+            manager.parents[dense] = ENTITY_INVALID_ID;
+            continue;
+        }
+        manager.nextSiblings[dense] = manager.firstChildren[parent];
+        manager.firstChildren[parent] = manager.ids[dense];
+    }
+
+    manager.localTransforms.assign(count, mat4_identity());
+    manager.worldTransforms.assign(count, mat4_identity());
+    manager.transformDirty.assign(count, 0);
+    manager.dirtyTransforms.clear();
+    for (std::uint32_t dense = 0; dense < count; ++dense) {
+        markTransformDirty(manager, dense);
+    }
+
+    for (std::unique_ptr<EntityQuery> &query : manager.queries) {
+        query->dense.clear();
+        query->slots.assign(manager.count(), ENTITY_INVALID_INDEX);
+        for (std::uint32_t dense = 0; dense < manager.count(); ++dense) {
+            if (query->matches(manager.signatures[dense])) {
+                queryAdd(*query, dense);
+            }
+        }
+    }
 }
@@ -1,8 +1,9 @@
 #ifndef ENTITY_H
 #define ENTITY_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 #include "../core/math.h"
@@ -11,33 +12,152 @@
 enum EntityType {
     Player,
     Enemy,
+    Prop, // static scenery, no velocity
 };
 
 const std::string getEntityTypeStr(const EntityType type);
 
-typedef unsigned int EntityId;
+// Every entity has a row in every column, its signature says which of them are meaningful.
+// Tags are components without data.
+enum ComponentType {
+    COMPONENT_TRANSFORM, // positions, scales
+    COMPONENT_VELOCITY,
+    COMPONENT_MESH,
+    COMPONENT_PLAYER,
+    COMPONENT_ENEMY,
 
-struct Entity {
-    EntityId id;
-    EntityType type;
-    Vector3 position;
-    Vector3 scale;
+    COMPONENT_COUNT,
+};
+
+typedef std::uint32_t ComponentMask;
+
+static_assert(COMPONENT_COUNT <= 32);
+
+[[nodiscard]] constexpr ComponentMask componentBit(ComponentType component) {
+    return 1u << component;
+}
+
+// The components an entity of the given type starts out with.
+[[nodiscard]] ComponentMask getEntityTypeSignature(EntityType type);
+
+// An EntityId is a 32-bit generational handle: the low bits index into the sparse table, the
+// high bits hold the generation of that slot when the handle was issued. Destroying an entity
+// bumps the generation, so any handle still pointing at the old slot is detected as stale.
+typedef std::uint32_t EntityId;
+
+constexpr unsigned int ENTITY_INDEX_BITS = 20;
+constexpr unsigned int ENTITY_GENERATION_BITS = 32 - ENTITY_INDEX_BITS;
+constexpr std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+constexpr std::uint32_t ENTITY_GENERATION_MASK = (1u << ENTITY_GENERATION_BITS) - 1;
+constexpr std::uint32_t ENTITY_MAX_COUNT = ENTITY_INDEX_MASK;
+
+constexpr EntityId ENTITY_INVALID_ID = 0xFFFFFFFF;
+constexpr std::uint32_t ENTITY_INVALID_INDEX = 0xFFFFFFFF;
+
+[[nodiscard]] constexpr std::uint32_t entityIdIndex(EntityId id) {
+    return id & ENTITY_INDEX_MASK;
+}
+
+[[nodiscard]] constexpr std::uint32_t entityIdGeneration(EntityId id) {
+    return (id >> ENTITY_INDEX_BITS) & ENTITY_GENERATION_MASK;
+}
+
+[[nodiscard]] constexpr EntityId makeEntityId(std::uint32_t index, std::uint32_t generation) {
+    return ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS) |
+           (index & ENTITY_INDEX_MASK);
+}
 
-    MeshId mesh = 0;
+// Cached "has all of `all`, none of `none`" filter. The matching dense indices are maintained
+// incrementally on every structural or signature change, so systems iterate `dense` directly
+// instead of testing every entity each tick. `dense` is unordered.
+struct EntityQuery {
+    ComponentMask all = 0;
+    ComponentMask none = 0;
+
+    std::vector<std::uint32_t> dense;
+    // dense index -> position in `dense`, ENTITY_INVALID_INDEX if the row does not match
+    std::vector<std::uint32_t> slots;
+
+    bool matches(ComponentMask signature) const {
+        return (signature & all) == all && (signature & none) == 0;
+    }
+
+    std::uint32_t count() const {
+        return static_cast<std::uint32_t>(dense.size());
+    }
 };
 
+// Entity data is stored as struct-of-arrays. Every column below is indexed by the same dense
+// index, and the dense range [0, count()) is always tightly packed: destroying an entity moves
+// the last row into the hole. Dense indices are therefore only stable until the next structural
+// change, hold on to the EntityId instead.
+//
+// Positions and scales are relative to the parent, entities without one are in world space. The
+// matrices built from them are cached, see transform.h.
 struct EntityManager {
-    std::vector<Entity *> entities;
-    std::unordered_map<EntityId, Entity *> entityMap;
-    std::unordered_map<EntityType, std::vector<Entity *>> entityTypeMap;
-    EntityId currentId = 0;
+    // dense columns
+    std::vector<EntityId> ids;
+    std::vector<ComponentMask> signatures;
+    std::vector<Vector3> positions;
+    std::vector<Vector3> velocities;
+    std::vector<Vector3> scales;
+    std::vector<MeshId> meshes;
+
+    // ENTITY_INVALID_ID for roots, the children of a row are a list threaded through nextSiblings
+    std::vector<EntityId> parents;
+    std::vector<EntityId> firstChildren;
+    std::vector<EntityId> nextSiblings;
+    // translate(position) * scale(scale), and the parent's world transform times that
+    std::vector<Mat4> localTransforms;
+    std::vector<Mat4> worldTransforms;
+    // set when position or scale changed since the last updateTransforms
+    std::vector<std::uint8_t> transformDirty;
+    // the rows flagged above, by id since rows move
+    std::vector<EntityId> dirtyTransforms;
+
+    // sparse table, indexed by entityIdIndex(id)
+    std::vector<std::uint32_t> denseIndex;
+    std::vector<std::uint32_t> generations;
+    std::vector<std::uint32_t> freeIndices;
+
+    // heap allocated so pointers handed out by registerQuery stay valid
+    std::vector<std::unique_ptr<EntityQuery>> queries;
+
+    std::uint32_t count() const {
+        return static_cast<std::uint32_t>(ids.size());
+    }
 };
 
-[[nodiscard]] Entity *makeEntity(EntityManager &manager, EntityType type);
+[[nodiscard]] EntityId makeEntity(EntityManager &manager, EntityType type);
+// Hands out a handle without adding a row, the entity is not alive until makeReservedEntity is
+// called with it. Used to give out ids for entities whose creation is deferred.
+[[nodiscard]] EntityId reserveEntityId(EntityManager &manager);
+void makeReservedEntity(EntityManager &manager, EntityId id, EntityType type);
 void destroyEntity(EntityManager &manager, EntityId id);
 void destroyAllEntities(EntityManager &manager);
-[[nodiscard]] Entity *getEntityById(const EntityManager &manager, EntityId id);
-[[nodiscard]] std::vector<Entity *> *getEntitiesByTag(const EntityManager &manager,
-                                                      EntityType type);
+[[nodiscard]] bool isEntityAlive(const EntityManager &manager, EntityId id);
+// Returns the dense index of the entity, or ENTITY_INVALID_INDEX if the handle is stale.
+[[nodiscard]] std::uint32_t getEntityIndex(const EntityManager &manager, EntityId id);
+
+[[nodiscard]] bool hasComponent(const EntityManager &manager, EntityId id, ComponentType component);
+void addComponent(EntityManager &manager, EntityId id, ComponentType component);
+void removeComponent(EntityManager &manager, EntityId id, ComponentType component);
+
+// Call after writing an entity's position or scale, its subtree is brought up to date by the
+// next updateTransforms. New entities start out dirty.
+void markTransformDirty(EntityManager &manager, std::uint32_t dense);
+// Attaches `child` to `parent`, or makes it a root when `parent` is ENTITY_INVALID_ID. Its
+// position and scale are then relative to the parent. Fails on stale handles and when `child` is
+// `parent` or one of its ancestors. Destroying an entity turns its children into roots.
+bool setParent(EntityManager &manager, EntityId child, EntityId parent);
+
+// Returns the query for (all, none), creating and filling it on first use. The pointer stays
+// valid for the lifetime of the manager.
+[[nodiscard]] EntityQuery *registerQuery(EntityManager &manager, ComponentMask all,
+                                         ComponentMask none = 0);
+// Rebuilds the sparse table, free list, child lists and every query from the dense columns and
+// `parents`, and marks every transform dirty. For code that fills the columns in bulk, like
+// loading a save.
+void rebuildEntityIndex(EntityManager &manager);
 
 #endif
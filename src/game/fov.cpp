@@ -0,0 +1,163 @@
+#include <algorithm>
+
+#include "fov.h"
+
+void initTileBitset(TileBitset &bits, std::uint32_t width, std::uint32_t height) {
+    bits.width = width;
+    bits.height = height;
+    bits.blocksX = (width + TILE_BLOCK_SIZE - 1) / TILE_BLOCK_SIZE;
+    bits.blocksY = (height + TILE_BLOCK_SIZE - 1) / TILE_BLOCK_SIZE;
+    bits.words.assign(static_cast<std::size_t>(bits.blocksX) * bits.blocksY, 0);
+}
+
+void initFieldOfView(FieldOfView &fov, const Dungeon &dungeon, std::uint32_t radius) {
+    fov.radius = radius;
+    fov.viewerX = 0xFFFFFFFF;
+    fov.viewerY = 0xFFFFFFFF;
+    fov.dirty = true;
+    fov.recomputes = 0;
+
+    initTileBitset(fov.visible, dungeon.width, dungeon.height);
+    initTileBitset(fov.explored, dungeon.width, dungeon.height);
+}
+
+struct BlockRange {
+    std::uint32_t x0, y0, x1, y1; // inclusive
+};
+
+// the blocks a viewer at (x, y) can possibly light
+static BlockRange viewBlocks(const FieldOfView &fov, std::uint32_t x, std::uint32_t y) {
+    std::uint32_t minX = x > fov.radius ? x - fov.radius : 0;
+    std::uint32_t minY = y > fov.radius ? y - fov.radius : 0;
+    std::uint32_t maxX = std::min(x + fov.radius, fov.visible.width - 1);
+    std::uint32_t maxY = std::min(y + fov.radius, fov.visible.height - 1);
+
+    return BlockRange{minX / TILE_BLOCK_SIZE, minY / TILE_BLOCK_SIZE, maxX / TILE_BLOCK_SIZE,
+                      maxY / TILE_BLOCK_SIZE};
+}
+
+static bool isOpaque(const Dungeon &dungeon, std::int32_t x, std::int32_t y) {
+    if (x < 0 || y < 0 || x >= (std::int32_t)dungeon.width || y >= (std::int32_t)dungeon.height) {
+        return true;
+    }
+    return dungeon.at((std::uint32_t)x, (std::uint32_t)y) == TILE_WALL;
+}
+
+struct Octant {
+    std::int32_t xx, xy, yx, yy;
+};
+
+// Scans the rows of one octant outwards from `row`, lighting everything between the `start` and
+// `end` slopes. A run of walls splits the arc, the part beyond it is scanned recursively.
+static void castLight(FieldOfView &fov, const Dungeon &dungeon, const Octant &octant,
+                      std::int32_t row, float start, float end) {
+    if (start < end) {
+        return;
+    }
+
+    std::int32_t radius = (std::int32_t)fov.radius;
+    std::int32_t viewerX = (std::int32_t)fov.viewerX;
+    std::int32_t viewerY = (std::int32_t)fov.viewerY;
+    float newStart = 0.0f;
+
+    for (std::int32_t distance = row; distance <= radius; ++distance) {
+        std::int32_t dy = -distance;
+        bool blocked = false;
+
+        for (std::int32_t dx = -distance; dx <= 0; ++dx) {
+            float leftSlope = ((float)dx - 0.5f) / ((float)dy + 0.5f);
+            float rightSlope = ((float)dx + 0.5f) / ((float)dy - 0.5f);
+            if (start < rightSlope) {
+                continue;
+            }
+            if (end > leftSlope) {
+                break;
+            }
+
+            std::int32_t x = viewerX + dx * octant.xx + dy * octant.xy;
+            std::int32_t y = viewerY + dx * octant.yx + dy * octant.yy;
+
+            // walls are lit too, the edge of the map is a wall nobody sees
+            bool opaque = isOpaque(dungeon, x, y);
+            bool inside = x >= 0 && y >= 0 && x < (std::int32_t)dungeon.width &&
+                          y < (std::int32_t)dungeon.height;
+            if (inside && dx * dx + dy * dy <= radius * radius) {
+                setTile(fov.visible, (std::uint32_t)x, (std::uint32_t)y);
+            }
+
+            if (blocked) {
+                if (opaque) {
+                    newStart = rightSlope;
+                } else {
+                    blocked = false;
+                    start = newStart;
+                }
+            } else if (opaque && distance < radius) {
+                blocked = true;
+                castLight(fov, dungeon, octant, distance + 1, start, leftSlope);
+                newStart = rightSlope;
+            }
+        }
+
+        if (blocked) {
+            break;
+        }
+    }
+}
+
+static constexpr Octant OCTANTS[8] = {
+    {1, 0, 0, 1},  {0, 1, 1, 0},  {0, -1, 1, 0}, {-1, 0, 0, 1},
+    {-1, 0, 0, -1}, {0, -1, -1, 0}, {0, 1, -1, 0}, {1, 0, 0, -1},
+};
+
+bool updateFieldOfView(FieldOfView &fov, const Dungeon &dungeon, std::uint32_t x,
+                       std::uint32_t y) {
+    if (x >= dungeon.width || y >= dungeon.height) {
+        return false;
+    }
+    if (!fov.dirty && x == fov.viewerX && y == fov.viewerY) {
+        return false;
+    }
+
+    // only the blocks the previous viewer could have lit hold any bits
+    if (fov.viewerX != 0xFFFFFFFF) {
+        BlockRange previous = viewBlocks(fov, fov.viewerX, fov.viewerY);
+        for (std::uint32_t by = previous.y0; by <= previous.y1; ++by) {
+            for (std::uint32_t bx = previous.x0; bx <= previous.x1; ++bx) {
+                fov.visible.words[by * fov.visible.blocksX + bx] = 0;
+            }
+        }
+    }
+
+    fov.viewerX = x;
+    fov.viewerY = y;
+    setTile(fov.visible, x, y);
+    for (const Octant &octant : OCTANTS) {
+        castLight(fov, dungeon, octant, 1, 1.0f, 0.0f);
+    }
+
+    BlockRange current = viewBlocks(fov, x, y);
+    for (std::uint32_t by = current.y0; by <= current.y1; ++by) {
+        for (std::uint32_t bx = current.x0; bx <= current.x1; ++bx) {
+            std::uint32_t block = by * fov.visible.blocksX + bx;
+            fov.explored.words[block] |= fov.visible.words[block];
+        }
+    }
+
+    fov.dirty = false;
+    fov.recomputes++;
+    return true;
+}
+
+void invalidateFieldOfView(FieldOfView &fov, std::uint32_t x, std::uint32_t y) {
+    if (fov.viewerX == 0xFFFFFFFF) {
+        return;
+    }
+
+    std::int64_t dx = (std::int64_t)x - fov.viewerX;
+    std::int64_t dy = (std::int64_t)y - fov.viewerY;
+    std::int64_t radius = fov.radius;
+    if (dx * dx + dy * dy <= radius * radius) {
+        fov.dirty = true;
+    }
+}
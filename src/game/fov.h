@@ -0,0 +1,82 @@
+#ifndef FOV_H
+#define FOV_H
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "../core/math.h"
+#include "dungeon.h"
+
+// One bit per tile, packed so that each 8x8 block of tiles is a single 64-bit word. Clearing or
+// merging a region is then a handful of word operations, and an empty bitset (no words) counts
+// as "everything set" so code that never built one keeps working.
+constexpr std::uint32_t TILE_BLOCK_SIZE = 8;
+
+struct TileBitset {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t blocksX = 0;
+    std::uint32_t blocksY = 0;
+    std::vector<std::uint64_t> words;
+};
+
+void initTileBitset(TileBitset &bits, std::uint32_t width, std::uint32_t height);
+
+[[nodiscard]] inline bool testTile(const TileBitset &bits, std::uint32_t x, std::uint32_t y) {
+    if (bits.words.empty()) {
+        return true;
+    }
+    if (x >= bits.width || y >= bits.height) {
+        return false;
+    }
+    std::uint64_t word = bits.words[(y / TILE_BLOCK_SIZE) * bits.blocksX + x / TILE_BLOCK_SIZE];
+    return (word >> ((y % TILE_BLOCK_SIZE) * TILE_BLOCK_SIZE + x % TILE_BLOCK_SIZE)) & 1;
+}
+
+inline void setTile(TileBitset &bits, std::uint32_t x, std::uint32_t y) {
+    bits.words[(y / TILE_BLOCK_SIZE) * bits.blocksX + x / TILE_BLOCK_SIZE] |=
+        1ull << ((y % TILE_BLOCK_SIZE) * TILE_BLOCK_SIZE + x % TILE_BLOCK_SIZE);
+}
+
+// Tests the tile an entity at `position` stands on, entities sit on the min corner of their tile.
+[[nodiscard]] inline bool testPosition(const TileBitset &bits, Vector3 position) {
+    if (bits.words.empty()) {
+        return true;
+    }
+    float x = std::floor(position.x + 0.5f);
+    float y = std::floor(position.z + 0.5f);
+    if (x < 0 || y < 0) {
+        return false;
+    }
+    return testTile(bits, (std::uint32_t)x, (std::uint32_t)y);
+}
+
+// Recursive shadowcasting from a single viewer. Only recomputed when the viewer moves to another
+// tile or an occluder inside its radius changes, and only the blocks around the viewer are
+// cleared and rewritten.
+struct FieldOfView {
+    std::uint32_t radius = 12;
+
+    std::uint32_t viewerX = 0xFFFFFFFF;
+    std::uint32_t viewerY = 0xFFFFFFFF;
+    bool dirty = true;
+
+    TileBitset visible;
+    // everything that has ever been visible
+    TileBitset explored;
+
+    std::uint32_t recomputes = 0;
+};
+
+void initFieldOfView(FieldOfView &fov, const Dungeon &dungeon, std::uint32_t radius);
+
+// Returns whether anything was recomputed.
+bool updateFieldOfView(FieldOfView &fov, const Dungeon &dungeon, std::uint32_t x,
+                       std::uint32_t y);
+
+// Call after tile (x, y) changed between wall and floor, marks the view for recomputation if the
+// viewer could see it.
+void invalidateFieldOfView(FieldOfView &fov, std::uint32_t x, std::uint32_t y);
+
+#endif
@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <utility>
+
+#include "pathfinding.h"
+
+// rows per job when deriving directions, a 512 wide row is only a couple of microseconds of work
+static constexpr std::uint32_t FLOW_ROW_GRAIN = 16;
+static constexpr std::uint32_t FLOW_STEER_GRAIN = 4096;
+
+static bool neighbourTile(const FlowField &field, std::uint32_t tile, int direction,
+                          std::uint32_t &out) {
+    std::uint32_t x = tile % field.width;
+    std::uint32_t y = tile / field.width;
+
+    switch (direction) {
+    case FLOW_WEST:
+        out = tile - 1;
+        return x > 0;
+    case FLOW_EAST:
+        out = tile + 1;
+        return x + 1 < field.width;
+    case FLOW_NORTH:
+        out = tile - field.width;
+        return y > 0;
+    case FLOW_SOUTH:
+        out = tile + field.width;
+        return y + 1 < field.height;
+    default:
+        return false;
+    }
+}
+
+static std::uint8_t computeDirection(const FlowField &field, std::uint32_t tile) {
+    std::uint32_t distance = field.distances[tile];
+    if (distance == FLOW_UNREACHABLE || distance == 0) {
+        return FLOW_NONE;
+    }
+
+    // first neighbour in enum order that is one step closer, so the result only depends on the
+    // distances and not on how they were computed
+    for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+        std::uint32_t next;
+        if (neighbourTile(field, tile, direction, next) &&
+            field.distances[next] == distance - 1) {
+            return static_cast<std::uint8_t>(direction);
+        }
+    }
+    return FLOW_NONE;
+}
+
+void initFlowField(FlowField &field, const Dungeon &dungeon) {
+    field.width = dungeon.width;
+    field.height = dungeon.height;
+    field.targetX = FLOW_UNREACHABLE;
+    field.targetY = FLOW_UNREACHABLE;
+    field.dirty = true;
+
+    field.distances.assign(dungeon.tiles.size(), FLOW_UNREACHABLE);
+    field.directions.assign(dungeon.tiles.size(), FLOW_NONE);
+    field.queue.reserve(dungeon.tiles.size());
+}
+
+static void rebuildFlowField(FlowField &field, const Dungeon &dungeon, JobSystem &jobs) {
+    std::fill(field.distances.begin(), field.distances.end(), FLOW_UNREACHABLE);
+
+    std::uint32_t target = field.targetY * field.width + field.targetX;
+    field.queue.clear();
+    if (dungeon.tiles[target] == TILE_FLOOR) {
+        field.distances[target] = 0;
+        field.queue.push_back(target);
+    }
+
+    // every floor tile enters the queue once, so it doubles as the visited order
+    for (std::size_t head = 0; head < field.queue.size(); ++head) {
+        std::uint32_t tile = field.queue[head];
+        std::uint32_t distance = field.distances[tile] + 1;
+
+        for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+            std::uint32_t next;
+            if (neighbourTile(field, tile, direction, next) &&
+                dungeon.tiles[next] == TILE_FLOOR && field.distances[next] == FLOW_UNREACHABLE) {
+                field.distances[next] = distance;
+                field.queue.push_back(next);
+            }
+        }
+    }
+
+    // directions only read the finished distances, rows are independent
+    parallelFor(jobs, 0, field.height, FLOW_ROW_GRAIN,
+                [&field](std::uint32_t begin, std::uint32_t end) {
+                    for (std::uint32_t tile = begin * field.width; tile < end * field.width;
+                         ++tile) {
+                        field.directions[tile] = computeDirection(field, tile);
+                    }
+                });
+
+    field.dirty = false;
+    field.rebuilds++;
+}
+
+bool updateFlowField(FlowField &field, const Dungeon &dungeon, std::uint32_t x, std::uint32_t y,
+                     JobSystem &jobs) {
+    if (x >= field.width || y >= field.height) {
+        return false;
+    }
+    if (!field.dirty && x == field.targetX && y == field.targetY) {
+        return false;
+    }
+
+    field.targetX = x;
+    field.targetY = y;
+    rebuildFlowField(field, dungeon, jobs);
+    return true;
+}
+
+static std::uint32_t closestNeighbourDistance(const FlowField &field, std::uint32_t tile) {
+    std::uint32_t best = FLOW_UNREACHABLE;
+    for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+        std::uint32_t next;
+        if (neighbourTile(field, tile, direction, next)) {
+            best = std::min(best, field.distances[next]);
+        }
+    }
+    return best;
+}
+
+// Opened a tile: it can only shorten paths, spread the improvement outwards.
+static void lowerTile(FlowField &field, const Dungeon &dungeon, std::uint32_t tile,
+                      std::vector<std::uint32_t> &touched) {
+    std::uint32_t best = closestNeighbourDistance(field, tile);
+    if (best == FLOW_UNREACHABLE) {
+        return;
+    }
+
+    field.distances[tile] = best + 1;
+    field.queue.clear();
+    field.queue.push_back(tile);
+
+    for (std::size_t head = 0; head < field.queue.size(); ++head) {
+        std::uint32_t current = field.queue[head];
+        std::uint32_t distance = field.distances[current] + 1;
+        touched.push_back(current);
+
+        for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+            std::uint32_t next;
+            if (neighbourTile(field, current, direction, next) &&
+                dungeon.tiles[next] == TILE_FLOOR && field.distances[next] > distance) {
+                field.distances[next] = distance;
+                field.queue.push_back(next);
+            }
+        }
+    }
+}
+
+// Closed a tile: every tile left without a neighbour one step closer lost its path, clear those
+// and fill them back in from the tiles around them that kept theirs.
+static void raiseTile(FlowField &field, const Dungeon &dungeon, std::uint32_t tile,
+                      std::vector<std::uint32_t> &touched) {
+    field.distances[tile] = FLOW_UNREACHABLE;
+    touched.push_back(tile);
+
+    std::vector<std::uint32_t> cleared;
+    field.queue.clear();
+    for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+        std::uint32_t next;
+        if (neighbourTile(field, tile, direction, next)) {
+            field.queue.push_back(next);
+        }
+    }
+
+    // A tile may be checked before the neighbour it relies on is cleared, clearing a tile
+    // queues its neighbours again so they get re-checked.
+    while (!field.queue.empty()) {
+        std::uint32_t current = field.queue.back();
+        field.queue.pop_back();
+
+        std::uint32_t distance = field.distances[current];
+        if (distance == FLOW_UNREACHABLE || distance == 0) {
+            continue;
+        }
+        if (closestNeighbourDistance(field, current) == distance - 1) {
+            continue;
+        }
+
+        field.distances[current] = FLOW_UNREACHABLE;
+        cleared.push_back(current);
+        for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+            std::uint32_t next;
+            if (neighbourTile(field, current, direction, next)) {
+                field.queue.push_back(next);
+            }
+        }
+    }
+
+    // seeds start at different distances, so this needs to be ordered
+    typedef std::pair<std::uint32_t, std::uint32_t> Seed; // distance, tile
+    std::priority_queue<Seed, std::vector<Seed>, std::greater<Seed>> open;
+    for (std::uint32_t current : cleared) {
+        std::uint32_t best = closestNeighbourDistance(field, current);
+        if (best != FLOW_UNREACHABLE) {
+            open.push(Seed{best + 1, current});
+        }
+    }
+
+    while (!open.empty()) {
+        auto [distance, current] = open.top();
+        open.pop();
+        if (distance >= field.distances[current]) {
+            continue;
+        }
+
+        field.distances[current] = distance;
+        for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+            std::uint32_t next;
+            if (neighbourTile(field, current, direction, next) &&
+                dungeon.tiles[next] == TILE_FLOOR && field.distances[next] > distance + 1) {
+                open.push(Seed{distance + 1, next});
+            }
+        }
+    }
+
+    touched.insert(touched.end(), cleared.begin(), cleared.end());
+}
+
+void setDungeonTile(FlowField &field, Dungeon &dungeon, std::uint32_t x, std::uint32_t y,
+                    Tile tile) {
+    std::uint32_t index = y * dungeon.width + x;
+    if (dungeon.tiles[index] == tile) {
+        return;
+    }
+    dungeon.tiles[index] = tile;
+
+    // not built yet, the next update does a full pass anyway
+    if (field.dirty || field.targetX == FLOW_UNREACHABLE) {
+        return;
+    }
+    if (x == field.targetX && y == field.targetY) {
+        field.dirty = true;
+        return;
+    }
+
+    std::vector<std::uint32_t> touched;
+    if (tile == TILE_FLOOR) {
+        lowerTile(field, dungeon, index, touched);
+    } else {
+        raiseTile(field, dungeon, index, touched);
+    }
+
+    // a changed distance can also flip which way its neighbours point
+    for (std::uint32_t current : touched) {
+        field.directions[current] = computeDirection(field, current);
+        for (int direction = FLOW_WEST; direction <= FLOW_SOUTH; ++direction) {
+            std::uint32_t next;
+            if (neighbourTile(field, current, direction, next)) {
+                field.directions[next] = computeDirection(field, next);
+            }
+        }
+    }
+}
+
+bool flowFieldTile(const FlowField &field, Vector3 position, std::uint32_t &x, std::uint32_t &y) {
+    float tileX = std::floor(position.x + 0.5f);
+    float tileY = std::floor(position.z + 0.5f);
+    if (tileX < 0 || tileY < 0 || tileX >= (float)field.width || tileY >= (float)field.height) {
+        return false;
+    }
+
+    x = static_cast<std::uint32_t>(tileX);
+    y = static_cast<std::uint32_t>(tileY);
+    return true;
+}
+
+void steerAlongFlowField(const FlowField &field, EntityManager &manager,
+                         const EntityQuery &chasers, float speed, JobSystem &jobs) {
+    const Vector3 *positions = manager.positions.data();
+    Vector3 *velocities = manager.velocities.data();
+    const std::uint32_t *rows = chasers.dense.data();
+
+    parallelFor(jobs, 0, chasers.count(), FLOW_STEER_GRAIN,
+                [=, &field](std::uint32_t begin, std::uint32_t end) {
+                    for (std::uint32_t i = begin; i < end; ++i) {
+                        std::uint32_t row = rows[i];
+                        Vector3 position = positions[row];
+                        velocities[row] = Vector3{0, 0, 0};
+
+                        std::uint32_t x, y;
+                        if (!flowFieldTile(field, position, x, y)) {
+                            continue;
+                        }
+
+                        std::uint32_t tile = y * field.width + x;
+                        std::uint32_t next;
+                        if (!neighbourTile(field, tile, field.directions[tile], next)) {
+                            continue;
+                        }
+
+                        Vector3 goal = Vector3{(float)(next % field.width), position.y,
+                                               (float)(next / field.width)};
+                        velocities[row] = (goal - position).normalized() * speed;
+                    }
+                });
+}
@@ -0,0 +1,68 @@
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/jobs.h"
+#include "../core/math.h"
+#include "dungeon.h"
+#include "entity.h"
+
+// Flow field towards a single target tile (the player). One BFS from the target gives every floor
+// tile its distance, and each tile then stores which neighbour is one step closer, so any number
+// of chasers just look up their tile instead of searching on their own. The field is only rebuilt
+// when the target moves to another tile, wall edits are patched in place.
+
+constexpr std::uint32_t FLOW_UNREACHABLE = 0xFFFFFFFF;
+
+enum FlowDirection : std::uint8_t {
+    FLOW_NONE, // on the target, a wall or cut off from the target
+    FLOW_WEST, // -x
+    FLOW_EAST, // +x
+    FLOW_NORTH, // -y
+    FLOW_SOUTH, // +y
+};
+
+struct FlowField {
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+
+    std::uint32_t targetX = FLOW_UNREACHABLE;
+    std::uint32_t targetY = FLOW_UNREACHABLE;
+    // set when the distances can't be patched and need a full rebuild
+    bool dirty = true;
+
+    // row-major like Dungeon::tiles
+    std::vector<std::uint32_t> distances;
+    std::vector<std::uint8_t> directions;
+
+    // scratch, kept around to avoid reallocating every rebuild
+    std::vector<std::uint32_t> queue;
+
+    std::uint32_t rebuilds = 0;
+};
+
+void initFlowField(FlowField &field, const Dungeon &dungeon);
+
+// Points the field at tile (x, y). Does nothing unless the target tile changed or the field is
+// dirty, returns whether it rebuilt.
+bool updateFlowField(FlowField &field, const Dungeon &dungeon, std::uint32_t x, std::uint32_t y,
+                     JobSystem &jobs);
+
+// Changes a tile and repairs the distances around it, only the tiles whose path went through the
+// change are touched. The game edits tiles through editDungeonTile, which also updates the view and
+// the chunk meshes.
+void setDungeonTile(FlowField &field, Dungeon &dungeon, std::uint32_t x, std::uint32_t y,
+                    Tile tile);
+
+// The tile an entity at `position` stands on, false when it is off the map. Entities sit on the
+// min corner of their tile, like the dungeon spawns.
+bool flowFieldTile(const FlowField &field, Vector3 position, std::uint32_t &x, std::uint32_t &y);
+
+// Sets the velocity of every entity in `chasers` to move one tile along the field at `speed`,
+// entities on the target or cut off from it stop.
+void steerAlongFlowField(const FlowField &field, EntityManager &manager,
+                         const EntityQuery &chasers, float speed, JobSystem &jobs);
+
+#endif
@@ -0,0 +1,410 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <string>
+#include <vector>
+
+// @PLATFORM_DEPENDENT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "../core/logger.h"
+#include "save.h"
+
+static_assert(sizeof(SaveHeader) % 8 == 0);
+static_assert(sizeof(Vector3) == 3 * sizeof(float));
+
+static constexpr std::uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+static constexpr std::uint64_t FNV_PRIME = 0x100000001B3ull;
+
+// FNV-1a's xor-then-multiply step applied to 32-bit words instead of bytes. Weaker than real
+// FNV-1a, but it only has to catch truncated or corrupted files, and every column is made of
+// 4-byte values, so a word at a time keeps validating a 100k entity file in the low milliseconds.
+// A trailing partial word is not hashed.
+static std::uint64_t hashSaveWords(std::uint64_t hash, const void *data, std::size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i + 4 <= size; i += 4) {
+        std::uint32_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash ^= word;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static bool writeAll(int fd, iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+
+        // partial write, skip what made it out and go again
+        std::size_t remaining = static_cast<std::size_t>(written);
+        while (iovcnt > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+// Makes a rename inside the directory holding `path` durable.
+static void syncDirectory(const char *path) {
+    std::string directory = std::filesystem::path(path).parent_path().string();
+    int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return;
+    }
+    if (fsync(fd) != 0) {
+        Log(LogLevel::WARNING,
+            std::format("[Save] Could not sync {}: {}", directory, strerror(errno)).c_str());
+    }
+    close(fd);
+}
+
+// Fills in everything but the payload hash and points `iov` at the header and the columns, which
+// are read in place.
+static void describeSave(const Simulation &sim, SaveHeader &header,
+                         iovec (&iov)[1 + SAVE_SECTION_COUNT]) {
+    const EntityManager &manager = sim.entities;
+    std::uint32_t count = manager.count();
+
+    const void *columns[SAVE_SECTION_COUNT] = {
+        manager.ids.data(),        manager.signatures.data(), manager.positions.data(),
+        manager.velocities.data(), manager.scales.data(),     manager.meshes.data(),
+        manager.generations.data(), manager.parents.data(),
+    };
+    std::uint64_t sizes[SAVE_SECTION_COUNT] = {
+        count * sizeof(EntityId), count * sizeof(ComponentMask), count * sizeof(Vector3),
+        count * sizeof(Vector3),  count * sizeof(Vector3),       count * sizeof(MeshId),
+        manager.generations.size() * sizeof(std::uint32_t),      count * sizeof(EntityId),
+    };
+
+    header = SaveHeader{};
+    header.magic = SAVE_MAGIC;
+    header.version = SAVE_VERSION;
+    header.headerSize = sizeof(SaveHeader);
+    header.entityCount = count;
+    header.slotCount = static_cast<std::uint32_t>(manager.generations.size());
+    header.tick = sim.tick;
+
+    iov[0] = iovec{&header, sizeof(header)};
+
+    std::uint64_t offset = sizeof(SaveHeader);
+    for (int i = 0; i < SAVE_SECTION_COUNT; ++i) {
+        header.sections[i] = SaveSectionEntry{offset, sizes[i]};
+        iov[i + 1] = iovec{const_cast<void *>(columns[i]), sizes[i]};
+        offset += sizes[i];
+    }
+}
+
+// Writes next to the target, flushes it to disk and only then renames over it, so a crash or
+// power loss mid-save leaves either the old file or the complete new one.
+static bool writeSaveFile(const char *path, iovec *iov, int iovcnt) {
+    std::string temporary = std::string(path) + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Could not open {}: {}", temporary, strerror(errno)).c_str());
+        return false;
+    }
+
+    bool ok = writeAll(fd, iov, iovcnt);
+    if (!ok) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Writing {} failed: {}", temporary, strerror(errno)).c_str());
+    }
+    if (ok && fsync(fd) != 0) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Syncing {} failed: {}", temporary, strerror(errno)).c_str());
+        ok = false;
+    }
+    if (close(fd) != 0 && ok) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Closing {} failed: {}", temporary, strerror(errno)).c_str());
+        ok = false;
+    }
+
+    if (ok && rename(temporary.c_str(), path) != 0) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Could not move save into place at {}: {}", path, strerror(errno))
+                .c_str());
+        ok = false;
+    }
+    if (ok) {
+        syncDirectory(path);
+    } else {
+        unlink(temporary.c_str());
+    }
+
+    return ok;
+}
+
+bool saveWorld(const char *path, const Simulation &sim) {
+    SaveHeader header;
+    iovec iov[1 + SAVE_SECTION_COUNT];
+    describeSave(sim, header, iov);
+
+    header.payloadHash = FNV_OFFSET;
+    for (int i = 1; i <= SAVE_SECTION_COUNT; ++i) {
+        header.payloadHash = hashSaveWords(header.payloadHash, iov[i].iov_base, iov[i].iov_len);
+    }
+
+    return writeSaveFile(path, iov, 1 + SAVE_SECTION_COUNT);
+}
+
+// Runs on the writer thread. The payload is only hashed here, with the copy made the simulation
+// has nothing left to wait for.
+static void writeSnapshot(SaveWriter *writer) {
+    std::uint8_t *bytes = writer->snapshot.data();
+    std::uint64_t hash = hashSaveWords(FNV_OFFSET, bytes + sizeof(SaveHeader),
+                                       writer->snapshot.size() - sizeof(SaveHeader));
+    std::memcpy(bytes + offsetof(SaveHeader, payloadHash), &hash, sizeof(hash));
+
+    iovec iov = iovec{bytes, writer->snapshot.size()};
+    writer->succeeded = writeSaveFile(writer->path.c_str(), &iov, 1);
+    writer->done.store(true, std::memory_order_release);
+}
+
+bool startSaveWorld(SaveWriter &writer, const char *path, const Simulation &sim) {
+    if (writer.thread.joinable() && !pollSaveWorld(writer)) {
+        return false;
+    }
+
+    SaveHeader header;
+    iovec iov[1 + SAVE_SECTION_COUNT];
+    describeSave(sim, header, iov);
+
+    std::size_t size = 0;
+    for (const iovec &part : iov) {
+        size += part.iov_len;
+    }
+    // reuses the buffer of the last save, after the first one this is only the copies
+    writer.snapshot.resize(size);
+    std::size_t offset = 0;
+    for (const iovec &part : iov) {
+        std::memcpy(writer.snapshot.data() + offset, part.iov_base, part.iov_len);
+        offset += part.iov_len;
+    }
+
+    writer.path = path;
+    writer.tick = sim.tick;
+    writer.done.store(false, std::memory_order_relaxed);
+    writer.thread = std::thread(writeSnapshot, &writer);
+    return true;
+}
+
+static void reapSave(SaveWriter &writer) {
+    writer.thread.join();
+    if (writer.succeeded) {
+        writer.saves++;
+        Log(LogLevel::DEBUG,
+            std::format("[Save] Saved tick {} to {}", writer.tick, writer.path).c_str());
+    } else {
+        writer.failures++;
+    }
+}
+
+bool pollSaveWorld(SaveWriter &writer) {
+    if (!writer.thread.joinable()) {
+        return true;
+    }
+    if (!writer.done.load(std::memory_order_acquire)) {
+        return false;
+    }
+    reapSave(writer);
+    return true;
+}
+
+void finishSaveWorld(SaveWriter &writer) {
+    if (writer.thread.joinable()) {
+        reapSave(writer);
+    }
+}
+
+static bool failValidation(SaveView &view, const char *path, const char *reason) {
+    Log(LogLevel::ERROR, std::format("[Save] {} is not a valid save: {}", path, reason).c_str());
+    closeSave(view);
+    return false;
+}
+
+bool openSave(const char *path, SaveView &out) {
+    out = SaveView{};
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Could not open {}: {}", path, strerror(errno)).c_str());
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SaveHeader)) {
+        close(fd);
+        Log(LogLevel::ERROR, std::format("[Save] {} is too small to be a save", path).c_str());
+        return false;
+    }
+
+    std::size_t fileSize = static_cast<std::size_t>(info.st_size);
+    void *mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        Log(LogLevel::ERROR,
+            std::format("[Save] Could not map {}: {}", path, strerror(errno)).c_str());
+        return false;
+    }
+    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    out.mapping = mapping;
+    out.mappingSize = fileSize;
+
+    const unsigned char *bytes = static_cast<const unsigned char *>(mapping);
+    const SaveHeader *header = static_cast<const SaveHeader *>(mapping);
+
+    if (header->magic != SAVE_MAGIC) {
+        return failValidation(out, path, "bad magic");
+    }
+    if (header->version != SAVE_VERSION) {
+        return failValidation(out, path, "unsupported version");
+    }
+    if (header->headerSize != sizeof(SaveHeader)) {
+        return failValidation(out, path, "header size mismatch");
+    }
+    if (header->slotCount > ENTITY_MAX_COUNT || header->entityCount > header->slotCount) {
+        return failValidation(out, path, "entity counts out of range");
+    }
+
+    std::uint64_t count = header->entityCount;
+    const std::uint64_t expectedSizes[SAVE_SECTION_COUNT] = {
+        count * sizeof(EntityId), count * sizeof(ComponentMask), count * sizeof(Vector3),
+        count * sizeof(Vector3),  count * sizeof(Vector3),       count * sizeof(MeshId),
+        header->slotCount * sizeof(std::uint32_t),     count * sizeof(EntityId),
+    };
+
+    // sections must tile the file exactly, in order, with nothing after the last one
+    std::uint64_t offset = sizeof(SaveHeader);
+    for (int i = 0; i < SAVE_SECTION_COUNT; ++i) {
+        const SaveSectionEntry &section = header->sections[i];
+        if (section.offset != offset || section.size != expectedSizes[i]) {
+            return failValidation(out, path, "section table does not match the counts");
+        }
+        offset += section.size;
+    }
+    if (offset != fileSize) {
+        return failValidation(out, path, "file size does not match the section table");
+    }
+
+    std::uint64_t hash =
+        hashSaveWords(FNV_OFFSET, bytes + sizeof(SaveHeader), fileSize - sizeof(SaveHeader));
+    if (hash != header->payloadHash) {
+        return failValidation(out, path, "payload hash mismatch");
+    }
+
+    auto section = [&](SaveSection s) { return bytes + header->sections[s].offset; };
+
+    out.header = header;
+    out.ids = reinterpret_cast<const EntityId *>(section(SAVE_SECTION_IDS));
+    out.signatures = reinterpret_cast<const ComponentMask *>(section(SAVE_SECTION_SIGNATURES));
+    out.positions = reinterpret_cast<const Vector3 *>(section(SAVE_SECTION_POSITIONS));
+    out.velocities = reinterpret_cast<const Vector3 *>(section(SAVE_SECTION_VELOCITIES));
+    out.scales = reinterpret_cast<const Vector3 *>(section(SAVE_SECTION_SCALES));
+    out.meshes = reinterpret_cast<const MeshId *>(section(SAVE_SECTION_MESHES));
+    out.generations = reinterpret_cast<const std::uint32_t *>(section(SAVE_SECTION_GENERATIONS));
+    out.parents = reinterpret_cast<const EntityId *>(section(SAVE_SECTION_PARENTS));
+
+    // every handle must point at a distinct slot of the generation it claims
+    std::vector<bool> used(header->slotCount, false);
+    for (std::uint32_t i = 0; i < header->entityCount; ++i) {
+        std::uint32_t index = entityIdIndex(out.ids[i]);
+        if (index >= header->slotCount || used[index] ||
+            out.generations[index] != entityIdGeneration(out.ids[i])) {
+            return failValidation(out, path, "entity handles are inconsistent");
+        }
+        used[index] = true;
+    }
+
+    // parents are entities of the file, and following them always ends at a root
+    for (std::uint32_t i = 0; i < header->entityCount; ++i) {
+        EntityId parent = out.parents[i];
+        if (parent == ENTITY_INVALID_ID) {
+            continue;
+        }
+        std::uint32_t index = entityIdIndex(parent);
+        if (index >= header->slotCount || !used[index] ||
+            out.generations[index] != entityIdGeneration(parent)) {
+            return failValidation(out, path, "parent handles are inconsistent");
+        }
+    }
+    std::vector<std::uint32_t> denseOf(header->slotCount, ENTITY_INVALID_INDEX);
+    for (std::uint32_t i = 0; i < header->entityCount; ++i) {
+        denseOf[entityIdIndex(out.ids[i])] = i;
+    }
+    for (std::uint32_t i = 0; i < header->entityCount; ++i) {
+        std::uint32_t steps = 0;
+        for (EntityId parent = out.parents[i]; parent != ENTITY_INVALID_ID;
+             parent = out.parents[denseOf[entityIdIndex(parent)]]) {
+            if (++steps > header->entityCount) {
+                return failValidation(out, path, "parents form a cycle");
+            }
+        }
+    }
+
+    return true;
+}
+
+void closeSave(SaveView &view) {
+    if (view.mapping != nullptr) {
+        munmap(view.mapping, view.mappingSize);
+    }
+    view = SaveView{};
+}
+
+bool loadWorld(const char *path, Simulation &sim) {
+    SaveView view;
+    if (!openSave(path, view)) {
+        return false;
+    }
+
+    std::uint32_t count = view.header->entityCount;
+    EntityManager &manager = sim.entities;
+
+    manager.ids.assign(view.ids, view.ids + count);
+    manager.signatures.assign(view.signatures, view.signatures + count);
+    manager.positions.assign(view.positions, view.positions + count);
+    manager.velocities.assign(view.velocities, view.velocities + count);
+    manager.scales.assign(view.scales, view.scales + count);
+    manager.meshes.assign(view.meshes, view.meshes + count);
+    manager.generations.assign(view.generations, view.generations + view.header->slotCount);
+    manager.parents.assign(view.parents, view.parents + count);
+    manager.denseIndex.resize(view.header->slotCount);
+    // also rebuilds the child lists and marks every transform dirty
+    rebuildEntityIndex(manager);
+
+    sim.tick = view.header->tick;
+
+    // recorded commands hold handles reserved against the world we just replaced
+    sim.commands.creates.clear();
+    sim.commands.destroys.clear();
+
+    spatialSync(sim.spatial, manager);
+
+    closeSave(view);
+
+    Log(LogLevel::DEBUG,
+        std::format("[Save] Loaded {} entities at tick {} from {}", count, sim.tick, path).c_str());
+    return true;
+}
@@ -0,0 +1,109 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../core/math.h"
+#include "entity.h"
+#include "simulation.h"
+
+// Binary world snapshot. The file is the header followed by the raw entity columns, so saving is
+// a single writev straight out of the EntityManager and loading maps the file and validates it in
+// place before copying each column once.
+//
+// Mesh references are stored as MeshIds, they resolve against a MeshRegistry that loaded the same
+// meshes in the same order.
+
+constexpr std::uint32_t SAVE_MAGIC = 0x56534C52; // "RLSV"
+constexpr std::uint32_t SAVE_VERSION = 2;
+
+enum SaveSection {
+    SAVE_SECTION_IDS,
+    SAVE_SECTION_SIGNATURES,
+    SAVE_SECTION_POSITIONS,
+    SAVE_SECTION_VELOCITIES,
+    SAVE_SECTION_SCALES,
+    SAVE_SECTION_MESHES,
+    SAVE_SECTION_GENERATIONS,
+    SAVE_SECTION_PARENTS,
+
+    SAVE_SECTION_COUNT,
+};
+
+struct SaveSectionEntry {
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+struct SaveHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint32_t entityCount;
+    // size of the sparse generation table, not every slot is alive
+    std::uint32_t slotCount;
+    std::uint32_t reserved;
+    std::uint64_t tick;
+    // word-wise FNV-style hash over everything after the header, see hashSaveWords
+    std::uint64_t payloadHash;
+    SaveSectionEntry sections[SAVE_SECTION_COUNT];
+};
+
+// Read-only view into a mapped save file. The pointers stay valid until closeSave.
+struct SaveView {
+    const SaveHeader *header = nullptr;
+
+    const EntityId *ids = nullptr;
+    const ComponentMask *signatures = nullptr;
+    const Vector3 *positions = nullptr;
+    const Vector3 *velocities = nullptr;
+    const Vector3 *scales = nullptr;
+    const MeshId *meshes = nullptr;
+    const std::uint32_t *generations = nullptr;
+    const EntityId *parents = nullptr;
+
+    void *mapping = nullptr;
+    std::size_t mappingSize = 0;
+};
+
+// Blocks until the file is on disk.
+bool saveWorld(const char *path, const Simulation &sim);
+bool loadWorld(const char *path, Simulation &sim);
+
+// Saves without stalling the frame loop. The world is copied out on the calling thread, a
+// memcpy of the columns, then hashed, written, synced and renamed into place on a thread of its
+// own. One save is in flight at a time.
+struct SaveWriter {
+    std::thread thread;
+    // set by the thread once it is done with `snapshot`
+    std::atomic<bool> done{false};
+    bool succeeded = false;
+
+    // header and columns as they go into the file
+    std::vector<std::uint8_t> snapshot;
+    std::string path;
+    std::uint64_t tick = 0;
+
+    std::uint32_t saves = 0;
+    std::uint32_t failures = 0;
+};
+
+// Call between ticks. Returns false, and leaves the world alone, while the previous save is
+// still being written.
+bool startSaveWorld(SaveWriter &writer, const char *path, const Simulation &sim);
+// Never blocks. Returns true once no save is in flight, counting and logging the one that just
+// finished.
+bool pollSaveWorld(SaveWriter &writer);
+// Waits for the save in flight, if any. Must be called before the writer goes away.
+void finishSaveWorld(SaveWriter &writer);
+
+// Maps and validates a save without copying it.
+bool openSave(const char *path, SaveView &out);
+void closeSave(SaveView &view);
+
+#endif
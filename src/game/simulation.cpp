@@ -0,0 +1,106 @@
+#include <bit>
+
+#include "simulation.h"
+#include "transform.h"
+
+// entities per job, small enough to balance across workers and large enough to amortize a
+// scheduling round-trip
+static constexpr std::uint32_t SIMULATION_GRAIN = 4096;
+
+void initSimulation(Simulation &sim) {
+    initSpatialHash(sim.spatial, 4.0f);
+    sim.moving = registerQuery(sim.entities, componentBit(COMPONENT_TRANSFORM) |
+                                                 componentBit(COMPONENT_VELOCITY));
+    sim.tick = 0;
+}
+
+void shutdownSimulation(Simulation &sim) {
+    applyEntityCommands(sim.commands, sim.entities);
+    destroyAllEntities(sim.entities);
+    clearSpatialHash(sim.spatial);
+}
+
+static void integrateVelocities(EntityManager &manager, const EntityQuery &query,
+                                SpatialHash &spatial, JobSystem &jobs, float deltaTime) {
+    Vector3 *positions = manager.positions.data();
+    const Vector3 *velocities = manager.velocities.data();
+    const std::uint32_t *rows = query.dense.data();
+
+    parallelFor(jobs, 0, query.count(), SIMULATION_GRAIN,
+                [=](std::uint32_t begin, std::uint32_t end) {
+                    for (std::uint32_t i = begin; i < end; ++i) {
+                        std::uint32_t row = rows[i];
+                        positions[row] = positions[row] + velocities[row] * deltaTime;
+                    }
+                });
+
+    // only the rows that moved, entities standing still keep their cached transforms and cells
+    for (std::uint32_t row : query.dense) {
+        if (velocities[row].x != 0 || velocities[row].y != 0 || velocities[row].z != 0) {
+            markTransformDirty(manager, row);
+            spatialMove(spatial, manager.ids[row], positions[row]);
+        }
+    }
+}
+
+static void applySpatialChanges(SpatialHash &spatial, const EntityManager &manager,
+                                const EntityChanges &changes) {
+    for (EntityId id : changes.destroyed) {
+        spatialRemove(spatial, id);
+    }
+
+    // skips the ones destroyed in the same batch
+    auto place = [&](EntityId id) {
+        std::uint32_t row = getEntityIndex(manager, id);
+        if (row != ENTITY_INVALID_INDEX) {
+            spatialMove(spatial, id, manager.positions[row]);
+        }
+    };
+    for (EntityId id : changes.created) {
+        place(id);
+    }
+    for (EntityId id : changes.reparented) {
+        place(id);
+    }
+}
+
+void updateSimulation(Simulation &sim, JobSystem &jobs, float deltaTime) {
+    integrateVelocities(sim.entities, *sim.moving, sim.spatial, jobs, deltaTime);
+
+    // sync point: systems are done iterating, apply spawns/despawns recorded this tick
+    applyEntityCommands(sim.commands, sim.entities, &sim.changes);
+    applySpatialChanges(sim.spatial, sim.entities, sim.changes);
+    sim.changes.clear();
+    updateTransforms(sim.entities, jobs);
+
+    sim.tick++;
+}
+
+static void hashBytes(std::uint64_t &hash, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        hash ^= (value >> (i * 8)) & 0xFF;
+        hash *= 0x100000001B3ull;
+    }
+}
+
+static void hashVector(std::uint64_t &hash, Vector3 value) {
+    hashBytes(hash, std::bit_cast<std::uint32_t>(value.x));
+    hashBytes(hash, std::bit_cast<std::uint32_t>(value.y));
+    hashBytes(hash, std::bit_cast<std::uint32_t>(value.z));
+}
+
+std::uint64_t checksumSimulation(const Simulation &sim) {
+    const EntityManager &manager = sim.entities;
+
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    hashBytes(hash, static_cast<std::uint32_t>(sim.tick));
+    for (std::uint32_t i = 0; i < manager.count(); ++i) {
+        hashBytes(hash, manager.ids[i]);
+        hashBytes(hash, manager.signatures[i]);
+        hashVector(hash, manager.positions[i]);
+        hashVector(hash, manager.velocities[i]);
+        hashVector(hash, manager.scales[i]);
+        hashBytes(hash, manager.parents[i]);
+    }
+    return hash;
+}
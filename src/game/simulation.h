@@ -0,0 +1,36 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+
+#include "../core/jobs.h"
+#include "commands.h"
+#include "entity.h"
+#include "spatial.h"
+
+struct Simulation {
+    EntityManager entities;
+    EntityCommandBuffer commands;
+    // filled at the sync point, scratch between ticks
+    EntityChanges changes;
+    SpatialHash spatial;
+
+    EntityQuery *moving = nullptr;
+
+    std::uint64_t tick = 0;
+};
+
+void initSimulation(Simulation &sim);
+void shutdownSimulation(Simulation &sim);
+
+// Advances the world by one fixed step. Systems run in parallel over the entity columns and must
+// not change the structure of the store, spawns and despawns go through `sim.commands` and are
+// applied at the sync point at the end of the tick. Transforms and the spatial hash are up to date
+// once it returns, the hash is only touched for entities that moved, spawned or despawned.
+void updateSimulation(Simulation &sim, JobSystem &jobs, float deltaTime);
+
+// FNV-1a over the ids, transforms and parents in dense order, equal checksums mean bit-identical
+// worlds.
+[[nodiscard]] std::uint64_t checksumSimulation(const Simulation &sim);
+
+#endif
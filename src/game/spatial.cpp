@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "spatial.h"
+
+static constexpr std::uint32_t SPATIAL_INVALID = 0xFFFFFFFF;
+
+static std::int32_t cellCoord(const SpatialHash &hash, float value) {
+    return static_cast<std::int32_t>(std::floor(value * hash.inverseCellSize));
+}
+
+static std::uint64_t cellKey(std::int32_t x, std::int32_t z) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+           static_cast<std::uint64_t>(static_cast<std::uint32_t>(z));
+}
+
+static std::uint64_t cellKeyFor(const SpatialHash &hash, Vector3 position) {
+    return cellKey(cellCoord(hash, position.x), cellCoord(hash, position.z));
+}
+
+static const std::vector<SpatialEntry> *findCell(const SpatialHash &hash, std::int32_t x,
+                                                 std::int32_t z) {
+    auto it = hash.cellLookup.find(cellKey(x, z));
+    return (it == hash.cellLookup.end()) ? nullptr : &hash.cells[it->second];
+}
+
+void initSpatialHash(SpatialHash &hash, float cellSize) {
+    clearSpatialHash(hash);
+    hash.cellSize = cellSize;
+    hash.inverseCellSize = 1.0f / cellSize;
+}
+
+void clearSpatialHash(SpatialHash &hash) {
+    hash.cellLookup.clear();
+    hash.cells.clear();
+    hash.freeCells.clear();
+    hash.entityCell.clear();
+    hash.entitySlot.clear();
+    hash.count = 0;
+}
+
+bool spatialContains(const SpatialHash &hash, EntityId id) {
+    std::uint32_t index = entityIdIndex(id);
+    if (index >= hash.entityCell.size() || hash.entityCell[index] == SPATIAL_INVALID) {
+        return false;
+    }
+    return hash.cells[hash.entityCell[index]][hash.entitySlot[index]].id == id;
+}
+
+void spatialInsert(SpatialHash &hash, EntityId id, Vector3 position) {
+    std::uint32_t index = entityIdIndex(id);
+    if (index >= hash.entityCell.size()) {
+        hash.entityCell.resize(index + 1, SPATIAL_INVALID);
+        hash.entitySlot.resize(index + 1, SPATIAL_INVALID);
+    }
+
+    std::uint64_t key = cellKeyFor(hash, position);
+    std::uint32_t cell;
+
+    auto it = hash.cellLookup.find(key);
+    if (it != hash.cellLookup.end()) {
+        cell = it->second;
+    } else {
+        if (!hash.freeCells.empty()) {
+            cell = hash.freeCells.back();
+            hash.freeCells.pop_back();
+        } else {
+            cell = static_cast<std::uint32_t>(hash.cells.size());
+            hash.cells.emplace_back();
+        }
+        hash.cellLookup[key] = cell;
+    }
+
+    std::vector<SpatialEntry> &entries = hash.cells[cell];
+    hash.entityCell[index] = cell;
+    hash.entitySlot[index] = static_cast<std::uint32_t>(entries.size());
+    entries.push_back(SpatialEntry{id, position});
+    hash.count++;
+}
+
+void spatialRemove(SpatialHash &hash, EntityId id) {
+    if (!spatialContains(hash, id)) {
+        return;
+    }
+
+    std::uint32_t index = entityIdIndex(id);
+    std::uint32_t cell = hash.entityCell[index];
+    std::uint32_t slot = hash.entitySlot[index];
+    std::vector<SpatialEntry> &entries = hash.cells[cell];
+
+    std::uint64_t key = cellKeyFor(hash, entries[slot].position);
+
+    entries[slot] = entries.back();
+    hash.entitySlot[entityIdIndex(entries[slot].id)] = slot;
+    entries.pop_back();
+
+    hash.entityCell[index] = SPATIAL_INVALID;
+    hash.entitySlot[index] = SPATIAL_INVALID;
+    hash.count--;
+
+    if (entries.empty()) {
+        hash.cellLookup.erase(key);
+        hash.freeCells.push_back(cell);
+    }
+}
+
+void spatialMove(SpatialHash &hash, EntityId id, Vector3 position) {
+    if (!spatialContains(hash, id)) {
+        spatialInsert(hash, id, position);
+        return;
+    }
+
+    std::uint32_t index = entityIdIndex(id);
+    SpatialEntry &entry = hash.cells[hash.entityCell[index]][hash.entitySlot[index]];
+
+    if (cellKeyFor(hash, entry.position) == cellKeyFor(hash, position)) {
+        entry.position = position;
+        return;
+    }
+
+    spatialRemove(hash, id);
+    spatialInsert(hash, id, position);
+}
+
+void spatialSync(SpatialHash &hash, const EntityManager &manager) {
+    clearSpatialHash(hash);
+    for (std::uint32_t i = 0; i < manager.count(); ++i) {
+        spatialInsert(hash, manager.ids[i], manager.positions[i]);
+    }
+}
+
+static float distanceSquaredXZ(Vector3 a, Vector3 b) {
+    float dx = a.x - b.x;
+    float dz = a.z - b.z;
+    return (dx * dx) + (dz * dz);
+}
+
+template <typename Visit>
+static void forEachCellInRange(const SpatialHash &hash, Vector3 min, Vector3 max, Visit visit) {
+    std::int32_t minX = cellCoord(hash, min.x);
+    std::int32_t minZ = cellCoord(hash, min.z);
+    std::int32_t maxX = cellCoord(hash, max.x);
+    std::int32_t maxZ = cellCoord(hash, max.z);
+
+    // a huge query over a sparse map touches fewer cells by walking the occupied ones
+    std::uint64_t rangeCells = static_cast<std::uint64_t>(maxX - minX + 1) *
+                               static_cast<std::uint64_t>(maxZ - minZ + 1);
+    if (rangeCells > hash.cellLookup.size()) {
+        for (const auto &[key, cell] : hash.cellLookup) {
+            visit(hash.cells[cell]);
+        }
+        return;
+    }
+
+    for (std::int32_t z = minZ; z <= maxZ; ++z) {
+        for (std::int32_t x = minX; x <= maxX; ++x) {
+            if (const std::vector<SpatialEntry> *entries = findCell(hash, x, z)) {
+                visit(*entries);
+            }
+        }
+    }
+}
+
+void spatialQueryRadius(const SpatialHash &hash, Vector3 center, float radius,
+                        std::vector<EntityId> &out) {
+    float radiusSquared = radius * radius;
+    Vector3 extent = Vector3{radius, 0, radius};
+
+    forEachCellInRange(hash, center - extent, center + extent,
+                       [&](const std::vector<SpatialEntry> &entries) {
+                           for (const SpatialEntry &entry : entries) {
+                               if (distanceSquaredXZ(entry.position, center) <= radiusSquared) {
+                                   out.push_back(entry.id);
+                               }
+                           }
+                       });
+}
+
+void spatialQueryAabb(const SpatialHash &hash, Vector3 min, Vector3 max,
+                      std::vector<EntityId> &out) {
+    forEachCellInRange(hash, min, max, [&](const std::vector<SpatialEntry> &entries) {
+        for (const SpatialEntry &entry : entries) {
+            const Vector3 &p = entry.position;
+            if (p.x >= min.x && p.x <= max.x && p.z >= min.z && p.z <= max.z) {
+                out.push_back(entry.id);
+            }
+        }
+    });
+}
+
+void spatialQueryNearest(const SpatialHash &hash, Vector3 center, std::uint32_t k,
+                         std::vector<EntityId> &out) {
+    if (k == 0 || hash.count == 0) {
+        return;
+    }
+
+    std::int32_t centerX = cellCoord(hash, center.x);
+    std::int32_t centerZ = cellCoord(hash, center.z);
+
+    std::vector<std::pair<float, EntityId>> candidates;
+    std::uint32_t seen = 0;
+
+    auto visitCell = [&](std::int32_t x, std::int32_t z) {
+        if (const std::vector<SpatialEntry> *entries = findCell(hash, x, z)) {
+            for (const SpatialEntry &entry : *entries) {
+                candidates.emplace_back(distanceSquaredXZ(entry.position, center), entry.id);
+            }
+            seen += static_cast<std::uint32_t>(entries->size());
+        }
+    };
+
+    // Grow square rings of cells around the center. Anything in ring r + 1 or beyond is at least
+    // r cells away, so once the k-th candidate is closer than that the answer is final.
+    for (std::int32_t ring = 0;; ++ring) {
+        if (ring == 0) {
+            visitCell(centerX, centerZ);
+        } else {
+            for (std::int32_t i = -ring; i <= ring; ++i) {
+                visitCell(centerX + i, centerZ - ring);
+                visitCell(centerX + i, centerZ + ring);
+            }
+            for (std::int32_t i = -ring + 1; i <= ring - 1; ++i) {
+                visitCell(centerX - ring, centerZ + i);
+                visitCell(centerX + ring, centerZ + i);
+            }
+        }
+
+        if (seen == hash.count) {
+            break;
+        }
+
+        if (candidates.size() >= k) {
+            auto kth = candidates.begin() + static_cast<std::ptrdiff_t>(k - 1);
+            std::nth_element(candidates.begin(), kth, candidates.end());
+            float bound = static_cast<float>(ring) * hash.cellSize;
+            if (kth->first <= bound * bound) {
+                break;
+            }
+        }
+    }
+
+    std::size_t resultCount = std::min<std::size_t>(k, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(resultCount),
+                      candidates.end());
+    for (std::size_t i = 0; i < resultCount; ++i) {
+        out.push_back(candidates[i].second);
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "../core/math.h"
+#include "entity.h"
+
+// Uniform grid over the ground (XZ) plane. Only occupied cells are stored, so the map can be any
+// size. Every query works on XZ distance, height is carried along but ignored.
+
+struct SpatialEntry {
+    EntityId id;
+    Vector3 position;
+};
+
+struct SpatialHash {
+    float cellSize = 4.0f;
+    float inverseCellSize = 0.25f;
+
+    std::unordered_map<std::uint64_t, std::uint32_t> cellLookup;
+    std::vector<std::vector<SpatialEntry>> cells;
+    std::vector<std::uint32_t> freeCells;
+
+    // indexed by entityIdIndex(id), locates the entry inside `cells`
+    std::vector<std::uint32_t> entityCell;
+    std::vector<std::uint32_t> entitySlot;
+
+    std::uint32_t count = 0;
+};
+
+void initSpatialHash(SpatialHash &hash, float cellSize);
+void clearSpatialHash(SpatialHash &hash);
+
+void spatialInsert(SpatialHash &hash, EntityId id, Vector3 position);
+void spatialRemove(SpatialHash &hash, EntityId id);
+// Cheap when the entity stays inside its cell, only crossing a cell boundary moves the entry.
+void spatialMove(SpatialHash &hash, EntityId id, Vector3 position);
+// Rebuilds the index from every entity in the store. For loads and entities made outside the
+// command buffer, ticks keep it current with spatialMove and spatialRemove instead.
+void spatialSync(SpatialHash &hash, const EntityManager &manager);
+
+[[nodiscard]] bool spatialContains(const SpatialHash &hash, EntityId id);
+
+// Queries append to `out`, they do not clear it.
+void spatialQueryRadius(const SpatialHash &hash, Vector3 center, float radius,
+                        std::vector<EntityId> &out);
+void spatialQueryAabb(const SpatialHash &hash, Vector3 min, Vector3 max,
+                      std::vector<EntityId> &out);
+// Closest `k` entities ordered by distance, nearest first.
+void spatialQueryNearest(const SpatialHash &hash, Vector3 center, std::uint32_t k,
+                         std::vector<EntityId> &out);
+
+#endif
@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cmath>
+
+#include "transform.h"
+
+// dirty subtrees per job, most are a single entity
+static constexpr std::uint32_t TRANSFORM_GRAIN = 256;
+
+Vector3 transformScale(const Mat4 &transform) {
+    auto column = [&](int c) {
+        return std::sqrt(transform[0][c] * transform[0][c] + transform[1][c] * transform[1][c] +
+                         transform[2][c] * transform[2][c]);
+    };
+    return Vector3{column(0), column(1), column(2)};
+}
+
+// Depth first from `root`, so every parent is done before its children read it. Returns how many
+// rows it updated.
+static std::uint32_t updateSubtree(EntityManager &manager, std::uint32_t root,
+                                   std::vector<std::uint32_t> &stack) {
+    std::uint32_t updated = 0;
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty()) {
+        std::uint32_t row = stack.back();
+        stack.pop_back();
+
+        if (manager.transformDirty[row]) {
+            manager.localTransforms[row] =
+                mat4_translate(manager.positions[row]) * mat4_scale(manager.scales[row]);
+            manager.transformDirty[row] = 0;
+        }
+
+        std::uint32_t parent = getEntityIndex(manager, manager.parents[row]);
+        manager.worldTransforms[row] =
+            parent == ENTITY_INVALID_INDEX
+                ? manager.localTransforms[row]
+                : manager.worldTransforms[parent] * manager.localTransforms[row];
+        updated++;
+
+        for (EntityId child = manager.firstChildren[row]; child != ENTITY_INVALID_ID;) {
+            std::uint32_t childRow = getEntityIndex(manager, child);
+            stack.push_back(childRow);
+            child = manager.nextSiblings[childRow];
+        }
+    }
+    return updated;
+}
+
+std::uint32_t updateTransforms(EntityManager &manager, JobSystem &jobs) {
+    // a dirty row under a dirty ancestor is covered by the ancestor's subtree, what is left are
+    // disjoint subtrees that can be updated in any order
+    std::vector<std::uint32_t> roots;
+    for (EntityId id : manager.dirtyTransforms) {
+        std::uint32_t row = getEntityIndex(manager, id);
+        if (row == ENTITY_INVALID_INDEX) {
+            continue;
+        }
+
+        bool covered = false;
+        for (EntityId ancestor = manager.parents[row]; ancestor != ENTITY_INVALID_ID && !covered;) {
+            std::uint32_t ancestorRow = getEntityIndex(manager, ancestor);
+            covered = manager.transformDirty[ancestorRow] != 0;
+            ancestor = manager.parents[ancestorRow];
+        }
+        if (!covered) {
+            roots.push_back(row);
+        }
+    }
+    manager.dirtyTransforms.clear();
+
+    std::atomic<std::uint32_t> updated{0};
+    parallelFor(jobs, 0, static_cast<std::uint32_t>(roots.size()), TRANSFORM_GRAIN,
+                [&](std::uint32_t begin, std::uint32_t end) {
+                    std::vector<std::uint32_t> stack;
+                    std::uint32_t count = 0;
+                    for (std::uint32_t i = begin; i < end; ++i) {
+                        count += updateSubtree(manager, roots[i], stack);
+                    }
+                    updated.fetch_add(count, std::memory_order_relaxed);
+                });
+    return updated.load(std::memory_order_relaxed);
+}
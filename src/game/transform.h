@@ -0,0 +1,27 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/jobs.h"
+#include "../core/math.h"
+#include "entity.h"
+
+// Cached local and world matrices of the entity hierarchy (see setParent in entity.h). Only rows
+// marked with markTransformDirty and everything below them are recomputed, parents before their
+// children, so static scenery costs nothing once its matrices are built. Dirty subtrees never
+// overlap and are spread across the workers.
+
+[[nodiscard]] inline Vector3 transformPosition(const Mat4 &transform) {
+    return Vector3{transform[0][3], transform[1][3], transform[2][3]};
+}
+
+// Length of each basis vector, the scale along x, y and z.
+[[nodiscard]] Vector3 transformScale(const Mat4 &transform);
+
+// Brings every dirty transform and its subtree up to date and clears the dirty rows. Returns how
+// many world transforms were recomputed. Must not run alongside anything writing the manager.
+std::uint32_t updateTransforms(EntityManager &manager, JobSystem &jobs);
+
+#endif
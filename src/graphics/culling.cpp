@@ -0,0 +1,110 @@
+#include <bit>
+#include <cmath>
+
+#include "culling.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define CULL_AVX
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CULL_SSE
+#endif
+
+Frustum extractFrustum(const Mat4 &m) {
+    const float(*row)[4] = m.entries;
+
+    Frustum frustum;
+    for (int i = 0; i < 3; ++i) {
+        for (int c = 0; c < 4; ++c) {
+            frustum.planes[i * 2][c] = row[3][c] + row[i][c];
+            frustum.planes[i * 2 + 1][c] = row[3][c] - row[i][c];
+        }
+    }
+
+    for (float *plane : frustum.planes) {
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        for (int c = 0; c < 4; ++c) {
+            plane[c] /= length;
+        }
+    }
+    return frustum;
+}
+
+static bool sphereVisible(const Frustum &frustum, float x, float y, float z, float radius) {
+    for (const float *plane : frustum.planes) {
+        if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void cullTail(const Frustum &frustum, const CullSpheres &spheres, std::uint32_t begin,
+                     std::vector<std::uint32_t> &visible) {
+    for (std::uint32_t i = begin; i < spheres.count(); ++i) {
+        if (sphereVisible(frustum, spheres.x[i], spheres.y[i], spheres.z[i], spheres.radius[i])) {
+            visible.push_back(i);
+        }
+    }
+}
+
+// appends base + every set bit of `mask`, lowest first so the output stays ordered
+static void appendMask(std::uint32_t base, unsigned int mask, std::vector<std::uint32_t> &visible) {
+    while (mask != 0) {
+        visible.push_back(base + static_cast<std::uint32_t>(std::countr_zero(mask)));
+        mask &= mask - 1;
+    }
+}
+
+void cullSpheresScalar(const Frustum &frustum, const CullSpheres &spheres,
+                       std::vector<std::uint32_t> &visible) {
+    visible.clear();
+    cullTail(frustum, spheres, 0, visible);
+}
+
+void cullSpheres(const Frustum &frustum, const CullSpheres &spheres,
+                 std::vector<std::uint32_t> &visible) {
+    visible.clear();
+    std::uint32_t count = spheres.count();
+    std::uint32_t i = 0;
+
+#if defined(CULL_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(&spheres.x[i]);
+        __m256 y = _mm256_loadu_ps(&spheres.y[i]);
+        __m256 z = _mm256_loadu_ps(&spheres.z[i]);
+        __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(&spheres.radius[i]));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const float *plane : frustum.planes) {
+            // same order of operations as the scalar test, so both agree to the bit
+            __m256 distance = _mm256_mul_ps(_mm256_set1_ps(plane[0]), x);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane[1]), y));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(plane[2]), z));
+            distance = _mm256_add_ps(distance, _mm256_set1_ps(plane[3]));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+        }
+        appendMask(i, static_cast<unsigned int>(_mm256_movemask_ps(inside)), visible);
+    }
+#elif defined(CULL_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(&spheres.x[i]);
+        __m128 y = _mm_loadu_ps(&spheres.y[i]);
+        __m128 z = _mm_loadu_ps(&spheres.z[i]);
+        __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(&spheres.radius[i]));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const float *plane : frustum.planes) {
+            __m128 distance = _mm_mul_ps(_mm_set1_ps(plane[0]), x);
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[1]), y));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(plane[2]), z));
+            distance = _mm_add_ps(distance, _mm_set1_ps(plane[3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negRadius));
+        }
+        appendMask(i, static_cast<unsigned int>(_mm_movemask_ps(inside)), visible);
+    }
+#endif
+
+    cullTail(frustum, spheres, i, visible);
+}
@@ -0,0 +1,50 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/math.h"
+
+// View frustum as six planes (left, right, bottom, top, near, far), each (a, b, c, d) with the
+// normal pointing inwards and normalized, so a*x + b*y + c*z + d is the signed distance.
+struct Frustum {
+    float planes[6][4];
+};
+
+// Gribb/Hartmann extraction from a row-major view-projection matrix with GL clip conventions.
+[[nodiscard]] Frustum extractFrustum(const Mat4 &viewProj);
+
+// Bounding spheres in struct-of-arrays layout so the test can load several at once.
+struct CullSpheres {
+    std::vector<float> x, y, z, radius;
+
+    void clear() {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    void push(Vector3 center, float r) {
+        x.push_back(center.x);
+        y.push_back(center.y);
+        z.push_back(center.z);
+        radius.push_back(r);
+    }
+
+    std::uint32_t count() const {
+        return static_cast<std::uint32_t>(x.size());
+    }
+};
+
+// Writes the indices of the spheres that touch the frustum to `visible`, in order. Runs eight at
+// a time with AVX, four with SSE and falls back to plain code elsewhere.
+void cullSpheres(const Frustum &frustum, const CullSpheres &spheres,
+                 std::vector<std::uint32_t> &visible);
+
+// Plain version of the above, kept for checking the SIMD paths against.
+void cullSpheresScalar(const Frustum &frustum, const CullSpheres &spheres,
+                       std::vector<std::uint32_t> &visible);
+
+#endif
@@ -0,0 +1,77 @@
+#include "../core/assert.h"
+#include "gpu_timer.h"
+#include "opengl.h"
+
+void initGpuTimers(GpuTimers &timers) {
+    glGenQueries(PROFILE_LATENCY * PROFILE_MAX_SCOPES, &timers.queries[0][0]);
+    timers.active = false;
+    for (auto &slot : timers.pending) {
+        for (bool &pending : slot) {
+            pending = false;
+        }
+    }
+}
+
+void shutdownGpuTimers(GpuTimers &timers) {
+    glDeleteQueries(PROFILE_LATENCY * PROFILE_MAX_SCOPES, &timers.queries[0][0]);
+}
+
+void beginGpuScope(GpuTimers &timers, const Profiler &profiler, std::uint32_t scope) {
+    ASSERT(!timers.active);
+    ASSERT(scope < PROFILE_MAX_SCOPES);
+
+    std::uint32_t slot = profiler.frame % PROFILE_LATENCY;
+    glBeginQuery(GL_TIME_ELAPSED, timers.queries[slot][scope]);
+    timers.frames[slot][scope] = profiler.frame;
+    timers.pending[slot][scope] = true;
+    timers.active = true;
+}
+
+void endGpuScope(GpuTimers &timers) {
+    ASSERT(timers.active);
+
+    glEndQuery(GL_TIME_ELAPSED);
+    timers.active = false;
+}
+
+static void readQuery(GpuTimers &timers, Profiler &profiler, std::uint32_t slot,
+                      std::uint32_t scope) {
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(timers.queries[slot][scope], GL_QUERY_RESULT, &nanoseconds);
+    recordProfileSample(profiler, timers.frames[slot][scope], scope,
+                        (float)((double)nanoseconds / 1000000.0));
+    timers.pending[slot][scope] = false;
+}
+
+static void collect(GpuTimers &timers, Profiler &profiler, bool wait) {
+    ASSERT(!timers.active);
+
+    // the slot the next frame reuses, its row is closed by the coming beginProfileFrame
+    std::uint32_t closing = (profiler.frame + 1) % PROFILE_LATENCY;
+
+    for (std::uint32_t slot = 0; slot < PROFILE_LATENCY; ++slot) {
+        for (std::uint32_t scope = 0; scope < PROFILE_MAX_SCOPES; ++scope) {
+            if (!timers.pending[slot][scope]) {
+                continue;
+            }
+
+            if (!wait && slot != closing) {
+                GLint available = 0;
+                glGetQueryObjectiv(timers.queries[slot][scope], GL_QUERY_RESULT_AVAILABLE,
+                                   &available);
+                if (!available) {
+                    continue;
+                }
+            }
+            readQuery(timers, profiler, slot, scope);
+        }
+    }
+}
+
+void collectGpuTimers(GpuTimers &timers, Profiler &profiler) {
+    collect(timers, profiler, false);
+}
+
+void finishGpuTimers(GpuTimers &timers, Profiler &profiler) {
+    collect(timers, profiler, true);
+}
@@ -0,0 +1,35 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <cstdint>
+
+#include "../core/profiler.h"
+
+// GL_TIME_ELAPSED queries around GPU work, filed into a Profiler. Each frame gets its own set of
+// queries and the results are read back PROFILE_LATENCY frames later, by which point the GPU has
+// almost always finished, so reading them never waits on work still in flight. Timer queries are
+// core since GL 3.3 and supported by every driver we run on, llvmpipe included.
+struct GpuTimers {
+    unsigned int queries[PROFILE_LATENCY][PROFILE_MAX_SCOPES] = {};
+    // frame each query was last issued for
+    std::uint64_t frames[PROFILE_LATENCY][PROFILE_MAX_SCOPES] = {};
+    bool pending[PROFILE_LATENCY][PROFILE_MAX_SCOPES] = {};
+
+    // GL only allows one time elapsed query at a time, so GPU scopes can't nest
+    bool active = false;
+};
+
+// Needs the GL context current.
+void initGpuTimers(GpuTimers &timers);
+void shutdownGpuTimers(GpuTimers &timers);
+
+void beginGpuScope(GpuTimers &timers, const Profiler &profiler, std::uint32_t scope);
+void endGpuScope(GpuTimers &timers);
+
+// Files every finished query into `profiler`. Call right before beginProfileFrame, queries for
+// the frame that is about to be closed are waited on so they are never dropped.
+void collectGpuTimers(GpuTimers &timers, Profiler &profiler);
+// Waits for every query still in flight, before closeProfiler.
+void finishGpuTimers(GpuTimers &timers, Profiler &profiler);
+
+#endif
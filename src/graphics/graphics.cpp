@@ -1,86 +1,60 @@
+#include <algorithm>
+#include <cmath>
 #include <format>
 
 #include "../core/logger.h"
 #include "../core/math.h"
 #include "../game/entity.h"
+#include "../game/transform.h"
+#include "graphics.h"
 #include "opengl.h"
+#include "shader.h"
+#include "stream_buffer.h"
 
-int uModelLoc;
-int uViewProjLoc;
+int uPositionScaleLoc;
+int uPositionOffsetLoc;
+int uPackedNormalsLoc;
 
-unsigned int initGraphics() {
-    const char *vertexShaderSource = R"(
-        #version 330 core
-        layout (location = 0) in vec3 aPos;
-        layout (location = 1) in vec3 aNormal;
-        layout (location = 2) in vec2 aUV;
-        uniform mat4 uModel;
-        uniform mat4 uViewProj;
-        out vec3 vNormal;
-        out vec2 vUV;
-        void main() {
-            gl_Position = uViewProj * uModel * vec4(aPos, 1.0);
-            vNormal = mat3(transpose(inverse(uModel))) * aNormal;
-            vUV = aUV;
-        }
-    )";
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        Log(LogLevel::FATAL, std::format("Vertex shader compilation failed: {}", infoLog).c_str());
-    }
-
-    const char *fragmentShaderSource = R"(
-        #version 330 core
-        in vec3 vNormal;
-        out vec4 FragColor;
-        void main() {
-            vec3 n = normalize(vNormal);
-            FragColor = vec4(n * 0.5 + 0.5, 1.0);
-        }
-    )";
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        Log(LogLevel::FATAL,
-            std::format("Fragment shader compilation failed: {}", infoLog).c_str());
-    }
+// per-frame uniforms and per-instance model matrices, both rewritten every frame
+StreamBuffer stream;
 
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+constexpr unsigned int INSTANCE_MODEL_LOCATION = 3;
+constexpr unsigned int FRAME_UNIFORM_BINDING = 0;
+// starting size of a stream region, enough for 16k instances
+constexpr std::size_t STREAM_REGION_SIZE = 1 << 20;
 
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        Log(LogLevel::FATAL, std::format("Failed to link shader program: {}", infoLog).c_str());
-    }
+// std140 layout of the Frame block in entity.vert, row_major so Mat4 goes in as is
+struct FrameUniforms {
+    Mat4 viewProj;
+};
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+unsigned int initGraphics() {
+    // relative to the build directory, like the rest of the resources
+    unsigned int shaderProgram = loadShaderProgram(
+        "../resources/shaders/entity.vert", "../resources/shaders/entity.frag", "shader_cache");
 
     glBindVertexArray(0);
 
     glEnable(GL_DEPTH_TEST);
 
-    uModelLoc = glGetUniformLocation(shaderProgram, "uModel");
-    uViewProjLoc = glGetUniformLocation(shaderProgram, "uViewProj");
+    GLuint frameBlock = glGetUniformBlockIndex(shaderProgram, "Frame");
+    if (frameBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(shaderProgram, frameBlock, FRAME_UNIFORM_BINDING);
+    } else {
+        Log(LogLevel::ERROR, "[Graphics] Shader has no Frame uniform block");
+    }
+
+    uPositionScaleLoc = glGetUniformLocation(shaderProgram, "uPositionScale");
+    uPositionOffsetLoc = glGetUniformLocation(shaderProgram, "uPositionOffset");
+    uPackedNormalsLoc = glGetUniformLocation(shaderProgram, "uPackedNormals");
+
+    initStreamBuffer(stream, STREAM_REGION_SIZE);
 
     return shaderProgram;
 }
 
 void shutdownGraphics(unsigned int shaderProgram) {
+    shutdownStreamBuffer(stream);
     glDeleteProgram(shaderProgram);
 }
 
@@ -88,35 +62,209 @@ float toRadians(const float degrees) {
     return degrees * (3.141592 / 180);
 }
 
-void drawEntities(const std::vector<Entity *> &entities, unsigned int shaderProgram,
-                  const MeshRegistry &registry, int width, int height) {
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+void captureRenderSnapshot(RenderSnapshot &snapshot, const EntityManager &manager,
+                           const EntityQuery &drawable) {
+    // resize() reuses the snapshot's storage, after warm-up publishing does not allocate
+    std::size_t count = drawable.dense.size();
+    snapshot.ids.resize(count);
+    snapshot.signatures.resize(count);
+    snapshot.positions.resize(count);
+    snapshot.scales.resize(count);
+    snapshot.transforms.resize(count);
+    snapshot.meshes.resize(count);
 
-    glUseProgram(shaderProgram);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint32_t row = drawable.dense[i];
+        const Mat4 &world = manager.worldTransforms[row];
+        snapshot.ids[i] = manager.ids[row];
+        snapshot.signatures[i] = manager.signatures[row];
+        snapshot.positions[i] = transformPosition(world);
+        snapshot.scales[i] = transformScale(world);
+        snapshot.transforms[i] = world;
+        snapshot.meshes[i] = manager.meshes[row];
+    }
+}
 
-    glViewport(0, 0, width, height);
-    Mat4 proj = mat4_perspective(toRadians(90.0f), (float)width / (float)height, 0.1f, 100.0f);
-
-    for (Entity *e : entities) {
-        if (e->type == EntityType::Player) {
-            Mat4 view =
-                mat4_lookAt(Vector3{e->position.x, 7, e->position.z + 5}, e->position, {0, 1, 0});
-            Mat4 viewProj = proj * view;
-            glUniformMatrix4fv(uViewProjLoc, 1, GL_TRUE, &viewProj.entries[0][0]);
+void matchPreviousPositions(const RenderSnapshot &previous, const RenderSnapshot &current,
+                            std::vector<std::uint32_t> &sparse, std::vector<Vector3> &out) {
+    for (std::uint32_t row = 0; row < previous.ids.size(); ++row) {
+        std::uint32_t index = entityIdIndex(previous.ids[row]);
+        if (index >= sparse.size()) {
+            sparse.resize(index + 1, ENTITY_INVALID_INDEX);
         }
+        sparse[index] = row;
+    }
 
-        Mat4 model = mat4_translate(e->position) * mat4_scale(e->scale);
-        glUniformMatrix4fv(uModelLoc, 1, GL_TRUE, &model.entries[0][0]);
+    out.resize(current.positions.size());
+    for (std::size_t row = 0; row < current.ids.size(); ++row) {
+        EntityId id = current.ids[row];
+        std::uint32_t index = entityIdIndex(id);
+        std::uint32_t previousRow = index < sparse.size() ? sparse[index] : ENTITY_INVALID_INDEX;
 
-        Mesh *m = registry.get(e->mesh);
-        glBindVertexArray(m->VAO);
-        if (m->indexCount > 0) {
-            glDrawElements(GL_TRIANGLES, (GLsizei)m->indexCount, GL_UNSIGNED_INT, (void *)0);
+        if (previousRow != ENTITY_INVALID_INDEX && previous.ids[previousRow] == id) {
+            out[row] = previous.positions[previousRow];
         } else {
-            glDrawArrays(GL_TRIANGLES, 0, (GLsizei)m->vertexCount);
+            out[row] = current.positions[row];
         }
     }
 
+    for (EntityId id : previous.ids) {
+        sparse[entityIdIndex(id)] = ENTITY_INVALID_INDEX;
+    }
+}
+
+// Streams this frame's uniforms and instance matrices, binds the uniforms and returns where the
+// matrices start.
+static std::size_t uploadFrame(const Mat4 &viewProj, const InstanceBatches &batches) {
+    FrameUniforms frame{viewProj};
+    std::size_t modelsSize = batches.models.size() * sizeof(Mat4);
+
+    // reserved up front, so growing can't move data uploaded earlier in the frame
+    reserveStream(stream, sizeof(FrameUniforms) + stream.uniformAlignment + modelsSize +
+                              sizeof(Mat4));
+    std::size_t frameOffset =
+        uploadStream(stream, &frame, sizeof(FrameUniforms), stream.uniformAlignment);
+    std::size_t modelsOffset =
+        uploadStream(stream, batches.models.data(), modelsSize, sizeof(Mat4));
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, stream.buffer,
+                      (GLintptr)frameOffset, (GLsizeiptr)sizeof(FrameUniforms));
+    glBindBuffer(GL_ARRAY_BUFFER, stream.buffer);
+    return modelsOffset;
+}
+
+// Points the mat4 attribute of the bound VAO at the batch's slice of the streamed matrices.
+static void bindInstanceAttributes(const InstanceBatch &batch, std::size_t modelsOffset) {
+    std::size_t offset = modelsOffset + batch.first * sizeof(Mat4);
+    for (unsigned int column = 0; column < 4; ++column) {
+        unsigned int location = INSTANCE_MODEL_LOCATION + column;
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(Mat4),
+                              (void *)(offset + column * 4 * sizeof(float)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
+
+// Binds what `batch` needs, skipping anything already bound by the batch before it. Meshes of a
+// vertex format share their arena's VAO.
+static void applyBatchState(const InstanceBatch &batch, const Mesh &mesh,
+                            const MeshRegistry &registry, unsigned int &boundProgram,
+                            unsigned int &boundVAO, MeshId &boundMesh, RenderStats &stats) {
+    if (batch.shader != boundProgram) {
+        glUseProgram(batch.shader);
+        boundProgram = batch.shader;
+        // the decode uniforms belong to the program
+        boundMesh = MESH_INVALID_ID;
+        stats.stateChanges++;
+    } else {
+        stats.stateChangesSkipped++;
+    }
+
+    unsigned int vao = registry.arenas[mesh.format].VAO;
+    if (vao != boundVAO) {
+        glBindVertexArray(vao);
+        boundVAO = vao;
+        stats.stateChanges++;
+    } else {
+        stats.stateChangesSkipped++;
+    }
+
+    if (batch.mesh != boundMesh) {
+        glUniform3fv(uPositionScaleLoc, 1, &mesh.quantization.scale.x);
+        glUniform3fv(uPositionOffsetLoc, 1, &mesh.quantization.offset.x);
+        glUniform1i(uPackedNormalsLoc, mesh.format == VERTEX_FORMAT_PACKED);
+        boundMesh = batch.mesh;
+    }
+}
+
+void drawEntities(const RenderSnapshot &current, const std::vector<Vector3> &previousPositions,
+                  float alpha, unsigned int shaderProgram, const MeshRegistry &registry,
+                  EntityRenderer &renderer) {
+    int width = current.width;
+    int height = current.height;
+
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glViewport(0, 0, width, height);
+
+    // the camera is worked out once, before any packet is drawn, it follows the player and stays
+    // at the origin when there is none
+    Vector3 target{0, 0, 0};
+    findCameraTarget(current, previousPositions, alpha, target);
+
+    Vector3 eye = Vector3{target.x, 7, target.z + 5};
+    float fov = toRadians(90.0f);
+    Mat4 proj = mat4_perspective(fov, (float)width / (float)height, 0.1f, 100.0f);
+    Mat4 viewProj = proj * mat4_lookAt(eye, target, {0, 1, 0});
+
+    InstanceCulling &culling = renderer.culling;
+    culling.frustum = extractFrustum(viewProj);
+    culling.eye = eye;
+    culling.lodScale = (float)height / (2.0f * std::tan(fov * 0.5f));
+    culling.meshBounds.resize(registry.current);
+    culling.meshLods.resize(registry.current);
+    for (const auto &[id, mesh] : registry.meshes) {
+        culling.meshBounds[id] = mesh->bounds;
+        MeshLodErrors &lods = culling.meshLods[id];
+        lods.count = mesh->lodCount;
+        for (unsigned int lod = 0; lod < mesh->lodCount; ++lod) {
+            lods.errors[lod] = mesh->lods[lod].error;
+        }
+    }
+
+    InstanceBatches &batches = renderer.batches;
+    buildInstanceBatches(current, previousPositions, alpha, shaderProgram, &culling, batches);
+
+    RenderStats &stats = renderer.stats;
+    stats.frames++;
+    stats.packets += batches.models.size();
+    stats.culled += batches.culled;
+
+    if (batches.batches.empty()) {
+        return;
+    }
+
+    // waits, rarely, for the GPU to finish the frame that last used this region
+    beginStreamFrame(stream);
+    std::size_t modelsOffset = uploadFrame(viewProj, batches);
+
+    // batches come out of the sorted queue, so equal state is adjacent and only bound once
+    unsigned int boundProgram = 0;
+    unsigned int boundVAO = 0;
+    MeshId boundMesh = MESH_INVALID_ID;
+    for (const InstanceBatch &batch : batches.batches) {
+        const Mesh *m = registry.get(batch.mesh);
+        applyBatchState(batch, *m, registry, boundProgram, boundVAO, boundMesh, stats);
+        bindInstanceAttributes(batch, modelsOffset);
+
+        const MeshLod &lod = m->lods[std::min(batch.lod, m->lodCount - 1)];
+        glDrawElementsInstancedBaseVertex(
+            GL_TRIANGLES, (GLsizei)lod.indexCount, GL_UNSIGNED_INT,
+            (void *)(lod.firstIndex * sizeof(unsigned int)), (GLsizei)batch.count,
+            (GLint)m->baseVertex);
+        stats.draws++;
+    }
+
     glBindVertexArray(0);
+    endStreamFrame(stream);
+}
+
+void readFramebuffer(int width, int height, std::vector<std::uint8_t> &rgba) {
+    if (width <= 0 || height <= 0) {
+        rgba.clear();
+        return;
+    }
+
+    std::size_t rowSize = (std::size_t)width * 4;
+    rgba.resize(rowSize * (std::size_t)height);
+
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+
+    // GL's first row is the bottom one
+    for (std::size_t top = 0, bottom = (std::size_t)height - 1; top < bottom; ++top, --bottom) {
+        std::swap_ranges(rgba.begin() + (std::ptrdiff_t)(top * rowSize),
+                         rgba.begin() + (std::ptrdiff_t)((top + 1) * rowSize),
+                         rgba.begin() + (std::ptrdiff_t)(bottom * rowSize));
+    }
 }
@@ -1,13 +1,80 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include <vector>
+
 #include "../game/entity.h"
+#include "../game/fov.h"
+#include "instancing.h"
 #include "mesh.h"
 
+// Immutable copy of everything the renderer needs from one simulation tick. The simulation fills
+// one after ticking and hands it to the render thread, which never touches the EntityManager.
+struct RenderSnapshot {
+    std::uint64_t tick = 0;
+    // wall clock time the snapshot was published and how far into the next tick the simulation
+    // was at that point
+    double publishTime = 0.0;
+    double alpha = 0.0;
+    double tickDelta = 1.0 / 60.0;
+
+    int width = 0;
+    int height = 0;
+
+    std::vector<EntityId> ids;
+    std::vector<ComponentMask> signatures;
+    // world space, taken from the cached world transforms
+    std::vector<Vector3> positions;
+    std::vector<Vector3> scales;
+    std::vector<Mat4> transforms;
+    std::vector<MeshId> meshes;
+
+    // tiles the player can currently see, actors outside of it are not drawn
+    TileBitset visible;
+};
+
 unsigned int initGraphics();
 void shutdownGraphics(unsigned int shaderProgram);
 
-void drawEntities(const std::vector<Entity *> &entities, unsigned int shaderProgram,
-                  const MeshRegistry &registry, int width, int height);
+// Copies the rows matched by `drawable` (transform + mesh). Transforms must be up to date, see
+// updateTransforms.
+void captureRenderSnapshot(RenderSnapshot &snapshot, const EntityManager &manager,
+                           const EntityQuery &drawable);
+
+// For every row of `current`, the entity's position in `previous`, or its current position if
+// it did not exist yet. `sparse` is scratch space reused between calls.
+void matchPreviousPositions(const RenderSnapshot &previous, const RenderSnapshot &current,
+                            std::vector<std::uint32_t> &sparse, std::vector<Vector3> &out);
+
+// Totals over every frame drawn.
+struct RenderStats {
+    std::uint64_t frames = 0;
+    std::uint64_t packets = 0;
+    std::uint64_t culled = 0;
+    std::uint64_t draws = 0;
+    // program and vertex array binds issued, and the ones dropped because the previous batch had
+    // already bound the same object
+    std::uint64_t stateChanges = 0;
+    std::uint64_t stateChangesSkipped = 0;
+};
+
+// Per-thread state of the entity pass, scratch is reused between frames.
+struct EntityRenderer {
+    InstanceBatches batches;
+    InstanceCulling culling;
+    RenderStats stats;
+};
+
+// Draws `current` with every position blended from `previousPositions` by `alpha`. Every visible
+// entity becomes a packet in a sorted render queue, runs of equal state become one instanced draw
+// and binds that would not change anything are skipped. Moving entities other than the player are
+// skipped when their tile is not in `current.visible`, and everything outside the camera frustum
+// is culled before it reaches GL.
+void drawEntities(const RenderSnapshot &current, const std::vector<Vector3> &previousPositions,
+                  float alpha, unsigned int shaderProgram, const MeshRegistry &registry,
+                  EntityRenderer &renderer);
+
+// Reads back the color of the bound framebuffer as RGBA8, rows top to bottom. Waits for the GPU.
+void readFramebuffer(int width, int height, std::vector<std::uint8_t> &rgba);
 
 #endif
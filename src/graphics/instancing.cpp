@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "graphics.h"
+#include "instancing.h"
+
+static bool isHidden(const RenderSnapshot &current, std::size_t row) {
+    // static props span many tiles and stay visible, actors hide outside the view
+    ComponentMask actor = componentBit(COMPONENT_VELOCITY);
+    return (current.signatures[row] & (actor | componentBit(COMPONENT_PLAYER))) == actor &&
+           !testPosition(current.visible, current.positions[row]);
+}
+
+static Vector3 blend(const RenderSnapshot &current, const std::vector<Vector3> &previousPositions,
+                     float alpha, std::size_t row) {
+    return previousPositions[row] + (current.positions[row] - previousPositions[row]) * alpha;
+}
+
+bool findCameraTarget(const RenderSnapshot &current, const std::vector<Vector3> &previousPositions,
+                      float alpha, Vector3 &out) {
+    for (std::size_t i = 0; i < current.ids.size(); ++i) {
+        if (current.signatures[i] & componentBit(COMPONENT_PLAYER)) {
+            out = blend(current, previousPositions, alpha, i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drops every row whose world space bounding sphere is outside the frustum.
+static void cullRows(const RenderSnapshot &current, const InstanceCulling &culling,
+                     InstanceBatches &out) {
+    out.spheres.clear();
+    for (std::size_t k = 0; k < out.rows.size(); ++k) {
+        std::uint32_t row = out.rows[k];
+        MeshId mesh = current.meshes[row];
+        Vector3 scale = current.scales[row];
+
+        if (mesh >= culling.meshBounds.size()) {
+            out.spheres.push(out.positions[k], std::numeric_limits<float>::infinity());
+            continue;
+        }
+
+        const MeshBounds &bounds = culling.meshBounds[mesh];
+        Vector3 center = out.positions[k] + Vector3{bounds.center.x * scale.x,
+                                                    bounds.center.y * scale.y,
+                                                    bounds.center.z * scale.z};
+        float largest = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+        out.spheres.push(center, bounds.radius * largest);
+    }
+
+    cullSpheres(culling.frustum, out.spheres, out.visible);
+
+    // visible is ascending, compacting in place never overwrites an entry still to be read
+    std::uint32_t kept = static_cast<std::uint32_t>(out.visible.size());
+    for (std::uint32_t k = 0; k < kept; ++k) {
+        out.rows[k] = out.rows[out.visible[k]];
+        out.positions[k] = out.positions[out.visible[k]];
+    }
+    out.culled = static_cast<std::uint32_t>(out.rows.size()) - kept;
+    out.rows.resize(kept);
+    out.positions.resize(kept);
+}
+
+unsigned int selectMeshLod(const MeshLodErrors &lods, float scale, float distance,
+                          float lodScale, float threshold) {
+    // errors only grow with the level, the first coarse one that fits is the coarsest
+    distance = std::max(distance, 1e-3f);
+    for (unsigned int lod = lods.count - 1; lod > 0; --lod) {
+        if (lods.errors[lod] * scale * lodScale / distance <= threshold) {
+            return lod;
+        }
+    }
+    return 0;
+}
+
+static unsigned int pickLod(const RenderSnapshot &current, const InstanceCulling &culling,
+                            std::uint32_t row, float distance) {
+    MeshId mesh = current.meshes[row];
+    if (culling.lodScale <= 0.0f || mesh >= culling.meshLods.size()) {
+        return 0;
+    }
+    Vector3 s = current.scales[row];
+    float scale = std::max({std::abs(s.x), std::abs(s.y), std::abs(s.z)});
+    return selectMeshLod(culling.meshLods[mesh], scale, distance, culling.lodScale,
+                         culling.lodThreshold);
+}
+
+void buildInstanceBatches(const RenderSnapshot &current,
+                          const std::vector<Vector3> &previousPositions, float alpha,
+                          unsigned int shader, const InstanceCulling *culling,
+                          InstanceBatches &out) {
+    out.batches.clear();
+    out.rows.clear();
+    out.positions.clear();
+    out.culled = 0;
+
+    for (std::size_t i = 0; i < current.ids.size(); ++i) {
+        if (!isHidden(current, i)) {
+            out.rows.push_back(static_cast<std::uint32_t>(i));
+            out.positions.push_back(blend(current, previousPositions, alpha, i));
+        }
+    }
+
+    if (culling != nullptr) {
+        cullRows(current, *culling, out);
+    }
+
+    clearRenderQueue(out.queue);
+    for (std::uint32_t k = 0; k < out.rows.size(); ++k) {
+        std::uint32_t row = out.rows[k];
+        float depth = 0.0f;
+        unsigned int lod = 0;
+        if (culling != nullptr) {
+            Vector3 offset = out.positions[k] - culling->eye;
+            depth = offset.dot(offset);
+            lod = pickLod(current, *culling, row, std::sqrt(depth));
+        }
+        pushRenderPacket(out.queue,
+                         makeRenderKey(RENDER_PASS_OPAQUE, shader, current.meshes[row], lod, depth),
+                         k);
+    }
+    sortRenderQueue(out.queue);
+
+    out.models.resize(out.queue.packets.size());
+    std::uint64_t state = 0;
+    for (std::uint32_t i = 0; i < out.queue.packets.size(); ++i) {
+        const RenderPacket &packet = out.queue.packets[i];
+
+        std::uint64_t packetState = packet.key >> RENDER_KEY_STATE_SHIFT;
+        if (out.batches.empty() || packetState != state) {
+            state = packetState;
+            out.batches.push_back(InstanceBatch{
+                renderKeyPass(packet.key), renderKeyShader(packet.key), renderKeyMesh(packet.key),
+                renderKeyLod(packet.key), i, 0});
+        }
+        out.batches.back().count++;
+
+        // the cached world transform, transposed into columns, with the blended position
+        Vector3 p = out.positions[packet.item];
+        const Mat4 &w = current.transforms[out.rows[packet.item]];
+        out.models[i] = Mat4{{
+            {w[0][0], w[1][0], w[2][0], 0},
+            {w[0][1], w[1][1], w[2][1], 0},
+            {w[0][2], w[1][2], w[2][2], 0},
+            {p.x, p.y, p.z, 1},
+        }};
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../core/math.h"
+#include "culling.h"
+#include "mesh.h"
+#include "render_queue.h"
+
+struct RenderSnapshot;
+
+// Just the errors of a mesh's levels, all the LOD selection needs.
+struct MeshLodErrors {
+    float errors[MESH_MAX_LODS] = {};
+    unsigned int count = 1;
+};
+
+// A run of packets with the same pass, shader, mesh and LOD, drawn with a single instanced call.
+struct InstanceBatch {
+    RenderPass pass;
+    unsigned int shader;
+    MeshId mesh;
+    unsigned int lod;
+    std::uint32_t first; // into InstanceBatches::models
+    std::uint32_t count;
+};
+
+struct InstanceBatches {
+    std::vector<InstanceBatch> batches;
+    // per-instance model matrices grouped by batch, stored column-major (entries[column][row])
+    // since that is how GL reads a mat4 vertex attribute
+    std::vector<Mat4> models;
+
+    // entities dropped by the frustum test in the last build
+    std::uint32_t culled = 0;
+
+    // scratch: surviving snapshot rows and their blended positions, bounds for the frustum test
+    // and one packet per surviving row
+    std::vector<std::uint32_t> rows;
+    std::vector<Vector3> positions;
+    CullSpheres spheres;
+    std::vector<std::uint32_t> visible;
+    RenderQueue queue;
+};
+
+struct InstanceCulling {
+    Frustum frustum;
+    // camera position, instances are ordered front to back from here
+    Vector3 eye{0, 0, 0};
+    // indexed by MeshId, meshes past the end are never culled
+    std::vector<MeshBounds> meshBounds;
+
+    // Pixels covered by one model unit at distance 1, viewport height / (2 tan(fov / 2)). Each
+    // instance draws the coarsest LOD whose error stays under `lodThreshold` pixels on screen,
+    // 0 always draws the full mesh.
+    float lodScale = 0.0f;
+    float lodThreshold = 1.0f;
+    // indexed by MeshId, meshes past the end only have their full LOD
+    std::vector<MeshLodErrors> meshLods;
+};
+
+// Coarsest LOD of `lods` whose error, for an instance `scale` times the mesh size `distance` away
+// from the camera, projects to at most `threshold` pixels.
+[[nodiscard]] unsigned int selectMeshLod(const MeshLodErrors &lods, float scale, float distance,
+                                         float lodScale, float threshold);
+
+// Blended position of the player in `current`, false if there is none.
+bool findCameraTarget(const RenderSnapshot &current, const std::vector<Vector3> &previousPositions,
+                      float alpha, Vector3 &out);
+
+// Emits a render packet per drawable row of `current`, with every position blended from
+// `previousPositions` by `alpha`, sorts them and cuts the result into batches of equal state.
+// Entities hidden by the snapshot's visibility are left out, and so is everything outside the
+// frustum when `culling` is given.
+void buildInstanceBatches(const RenderSnapshot &current,
+                          const std::vector<Vector3> &previousPositions, float alpha,
+                          unsigned int shader, const InstanceCulling *culling,
+                          InstanceBatches &out);
+
+#endif
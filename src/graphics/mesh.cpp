@@ -1,74 +1,357 @@
+#include <algorithm>
 #include <cstddef>
+#include <format>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "../core/logger.h"
 #include "mesh.h"
+#include "mesh_optimize.h"
 #include "opengl.h"
 
-Mesh *makeMesh(const Vertex *vertices, unsigned int vertexCount) {
-    Mesh *m = new Mesh;
-    m->vertexCount = vertexCount;
-    m->indexCount = 0;
+// the first makeMesh reserves this much, enough for the props so only the dungeon grows it
+constexpr unsigned int ARENA_INITIAL_VERTICES = 1 << 16;
+constexpr unsigned int ARENA_INITIAL_INDICES = 1 << 18;
+
+// location of the octahedral normal of packed vertices, after the instance matrix
+constexpr unsigned int PACKED_NORMAL_LOCATION = 7;
+
+static void setupArenaAttributes(const MeshArena &arena) {
+    glBindVertexArray(arena.VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, arena.VBO);
+
+    if (arena.format == VERTEX_FORMAT_PACKED) {
+        const GLsizei stride = sizeof(PackedVertex);
+
+        // location 0: position (unorm16 vec3, scaled by the shader)
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, stride,
+                              (void *)offsetof(PackedVertex, px));
+        glEnableVertexAttribArray(0);
+
+        // location 2: uv (half vec2)
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride,
+                              (void *)offsetof(PackedVertex, u));
+        glEnableVertexAttribArray(2);
+
+        // location 7: octahedral normal (snorm16 vec2)
+        glVertexAttribPointer(PACKED_NORMAL_LOCATION, 2, GL_SHORT, GL_TRUE, stride,
+                              (void *)offsetof(PackedVertex, nx));
+        glEnableVertexAttribArray(PACKED_NORMAL_LOCATION);
+    } else {
+        // location 0: position (vec3)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void *)offsetof(Vertex, px));
+        glEnableVertexAttribArray(0);
+
+        // location 1: normal (vec3)
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void *)offsetof(Vertex, nx));
+        glEnableVertexAttribArray(1);
+
+        // location 2: uv (vec2)
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                              (void *)offsetof(Vertex, u));
+        glEnableVertexAttribArray(2);
+    }
 
-    glGenVertexArrays(1, &m->VAO);
-    glBindVertexArray(m->VAO);
+    // the element buffer binding is VAO state, don't unbind it while the VAO is bound
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.EBO);
+    glBindVertexArray(0);
+}
 
-    glGenBuffers(1, &m->VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, m->VBO);
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexCount * sizeof(Vertex)), vertices,
-                 GL_STATIC_DRAW);
+// Moves `buffer` into new storage of `newSize` bytes, keeping the first `usedSize`. Goes through
+// the copy targets so no VAO's element binding is touched.
+static void growBuffer(unsigned int &buffer, std::size_t usedSize, std::size_t newSize) {
+    unsigned int grown;
+    glGenBuffers(1, &grown);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)newSize, nullptr, GL_STATIC_DRAW);
+
+    if (buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0,
+                            (GLsizeiptr)usedSize);
+        glDeleteBuffers(1, &buffer);
+    }
+    buffer = grown;
+}
 
-    // location 0: position (vec3)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, px));
-    glEnableVertexAttribArray(0);
+static void reserveMeshArena(MeshArena &arena, unsigned int vertexCount, unsigned int indexCount) {
+    unsigned int neededVertices = arena.vertexCount + vertexCount;
+    unsigned int neededIndices = arena.indexCount + indexCount;
+    if (arena.VAO != 0 && neededVertices <= arena.vertexCapacity &&
+        neededIndices <= arena.indexCapacity) {
+        return;
+    }
 
-    // location 1: normal (vec3)
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, nx));
-    glEnableVertexAttribArray(1);
+    if (arena.VAO == 0) {
+        glGenVertexArrays(1, &arena.VAO);
+    } else {
+        arena.grows++;
+    }
 
-    // location 2: uv (vec2)
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
-    glEnableVertexAttribArray(2);
+    if (neededVertices > arena.vertexCapacity || arena.VBO == 0) {
+        unsigned int capacity = std::max(
+            {neededVertices, arena.vertexCapacity * 2, ARENA_INITIAL_VERTICES});
+        std::size_t stride = vertexStride(arena.format);
+        growBuffer(arena.VBO, arena.vertexCount * stride, capacity * stride);
+        arena.vertexCapacity = capacity;
+    }
+    if (neededIndices > arena.indexCapacity || arena.EBO == 0) {
+        unsigned int capacity =
+            std::max({neededIndices, arena.indexCapacity * 2, ARENA_INITIAL_INDICES});
+        growBuffer(arena.EBO, arena.indexCount * sizeof(unsigned int),
+                   capacity * sizeof(unsigned int));
+        arena.indexCapacity = capacity;
+    }
 
-    glBindVertexArray(0);
-    return m;
+    // the attribute pointers captured the old buffers
+    setupArenaAttributes(arena);
+
+    Log(LogLevel::DEBUG,
+        std::format("[Mesh] {} arena holds {} vertices, {} indices ({} KiB)",
+                    arena.format == VERTEX_FORMAT_PACKED ? "Packed" : "Float",
+                    arena.vertexCapacity, arena.indexCapacity,
+                    (arena.vertexCapacity * vertexStride(arena.format) +
+                     arena.indexCapacity * sizeof(unsigned int)) /
+                        1024)
+            .c_str());
+}
+
+MeshId makeMesh(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount) {
+    std::vector<unsigned int> indices(vertexCount);
+    for (unsigned int i = 0; i < vertexCount; ++i) {
+        indices[i] = i;
+    }
+    return makeMesh(registry, vertices, vertexCount, indices.data(), vertexCount);
+}
+
+bool claimArenaRange(std::vector<ArenaRange> &free, unsigned int count, unsigned int &start) {
+    if (count == 0) {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < free.size(); ++i) {
+        ArenaRange &range = free[i];
+        if (range.count < count) {
+            continue;
+        }
+
+        start = range.start;
+        range.start += count;
+        range.count -= count;
+        if (range.count == 0) {
+            free.erase(free.begin() + (std::ptrdiff_t)i);
+        }
+        return true;
+    }
+    return false;
 }
 
-Mesh *makeMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices,
-               unsigned int indexCount) {
-    Mesh *m = new Mesh;
-    m->vertexCount = vertexCount;
-    m->indexCount = indexCount;
+void releaseArenaRange(std::vector<ArenaRange> &free, unsigned int start, unsigned int count) {
+    if (count == 0) {
+        return;
+    }
 
-    glGenVertexArrays(1, &m->VAO);
-    glBindVertexArray(m->VAO);
+    auto next = std::lower_bound(
+        free.begin(), free.end(), start,
+        [](const ArenaRange &range, unsigned int value) { return range.start < value; });
+    next = free.insert(next, ArenaRange{start, count});
 
-    glGenBuffers(1, &m->VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, m->VBO);
-    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexCount * sizeof(Vertex)), vertices,
-                 GL_STATIC_DRAW);
+    if (next + 1 != free.end() && next->start + next->count == (next + 1)->start) {
+        next->count += (next + 1)->count;
+        free.erase(next + 1);
+    }
+    if (next != free.begin() && (next - 1)->start + (next - 1)->count == next->start) {
+        (next - 1)->count += next->count;
+        free.erase(next);
+    }
+}
 
-    glGenBuffers(1, &m->EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m->EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(indexCount * sizeof(unsigned int)), indices,
-                 GL_STATIC_DRAW);
+// Gives a mesh's space back to its arena. A free range that reaches the end of the arena is
+// dropped from the list and the arena shrinks instead, so appending can reuse it.
+static void releaseMeshSpace(MeshRegistry &registry, const Mesh &m) {
+    MeshArena &arena = registry.arenas[m.format];
+    releaseArenaRange(arena.freeVertices, m.baseVertex, m.vertexCapacity);
+    releaseArenaRange(arena.freeIndices, m.indexStart, m.indexCapacity);
+
+    if (!arena.freeVertices.empty()) {
+        const ArenaRange &last = arena.freeVertices.back();
+        if (last.start + last.count == arena.vertexCount) {
+            arena.vertexCount = last.start;
+            arena.freeVertices.pop_back();
+        }
+    }
+    if (!arena.freeIndices.empty()) {
+        const ArenaRange &last = arena.freeIndices.back();
+        if (last.start + last.count == arena.indexCount) {
+            arena.indexCount = last.start;
+            arena.freeIndices.pop_back();
+        }
+    }
+}
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, px));
-    glEnableVertexAttribArray(0);
+// Claims `vertexCapacity` vertices and `indexCapacity` indices in the arena for `format`, from
+// the free lists when possible and at the end otherwise.
+static void placeMesh(MeshRegistry &registry, Mesh &m, VertexFormat format,
+                      unsigned int vertexCapacity, unsigned int indexCapacity) {
+    MeshArena &arena = registry.arenas[format];
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, nx));
-    glEnableVertexAttribArray(1);
+    m.format = format;
+    m.vertexCapacity = vertexCapacity;
+    m.indexCapacity = indexCapacity;
 
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *)offsetof(Vertex, u));
-    glEnableVertexAttribArray(2);
+    bool reusedVertices = claimArenaRange(arena.freeVertices, vertexCapacity, m.baseVertex);
+    bool reusedIndices = claimArenaRange(arena.freeIndices, indexCapacity, m.indexStart);
+    reserveMeshArena(arena, reusedVertices ? 0 : vertexCapacity,
+                     reusedIndices ? 0 : indexCapacity);
 
-    // IMPORTANT: do NOT unbind GL_ELEMENT_ARRAY_BUFFER while VAO is bound.
-    // Binding 0 to EBO here would detach it from the VAO.
-    glBindVertexArray(0);
+    if (!reusedVertices) {
+        m.baseVertex = arena.vertexCount;
+        arena.vertexCount += vertexCapacity;
+    }
+    if (!reusedIndices) {
+        m.indexStart = arena.indexCount;
+        arena.indexCount += indexCapacity;
+    }
+}
 
-    return m;
+// Writes the geometry into the mesh's place in its arena as a single LOD.
+static void writeMesh(const MeshRegistry &registry, Mesh &m, const Vertex *vertices,
+                      unsigned int vertexCount, const unsigned int *indices,
+                      unsigned int indexCount) {
+    const MeshArena &arena = registry.arenas[m.format];
+
+    m.vertexCount = vertexCount;
+    m.lods[0] = MeshLod{m.indexStart, indexCount, 0.0f};
+    m.lodCount = 1;
+    m.bounds = computeMeshBounds(vertices, vertexCount);
+    m.quantization = VertexQuantization{};
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.VBO);
+    if (m.format == VERTEX_FORMAT_PACKED) {
+        std::vector<PackedVertex> packed(vertexCount);
+        m.quantization = packVertices(vertices, vertexCount, packed.data());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(m.baseVertex * sizeof(PackedVertex)),
+                        (GLsizeiptr)(vertexCount * sizeof(PackedVertex)), packed.data());
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(m.baseVertex * sizeof(Vertex)),
+                        (GLsizeiptr)(vertexCount * sizeof(Vertex)), vertices);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)(m.indexStart * sizeof(unsigned int)),
+                    (GLsizeiptr)(indexCount * sizeof(unsigned int)), indices);
+}
+
+static VertexFormat pickFormat(const MeshRegistry &registry, const Vertex *vertices,
+                               unsigned int vertexCount) {
+    return registry.allowPacking ? chooseVertexFormat(vertices, vertexCount)
+                                 : VERTEX_FORMAT_FLOAT;
+}
+
+MeshId makeMesh(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount,
+                const unsigned int *indices, unsigned int indexCount) {
+    Mesh *m = registry.alloc();
+    placeMesh(registry, *m, pickFormat(registry, vertices, vertexCount), vertexCount,
+              indexCount);
+    writeMesh(registry, *m, vertices, vertexCount, indices, indexCount);
+    return registry.add(m);
+}
+
+void updateMesh(MeshRegistry &registry, MeshId id, const Vertex *vertices,
+                unsigned int vertexCount, const unsigned int *indices, unsigned int indexCount) {
+    Mesh *m = registry.get(id);
+
+    VertexFormat format = pickFormat(registry, vertices, vertexCount);
+    if (format != m->format || vertexCount > m->vertexCapacity ||
+        indexCount > m->indexCapacity) {
+        // the new geometry is all on the CPU, so the old space can be released first and even
+        // be part of the new one. Leave room so the next edits of this mesh fit.
+        releaseMeshSpace(registry, *m);
+        placeMesh(registry, *m, format, vertexCount * 2, indexCount * 2);
+    }
+    writeMesh(registry, *m, vertices, vertexCount, indices, indexCount);
+}
+
+void pushMeshUpload(MeshUploadQueue &queue, MeshUpload upload) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.pending.push_back(std::move(upload));
+}
+
+std::uint32_t applyMeshUploads(MeshUploadQueue &queue, MeshRegistry &registry) {
+    std::vector<MeshUpload> uploads;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        uploads.swap(queue.pending);
+    }
+
+    for (const MeshUpload &upload : uploads) {
+        updateMesh(registry, upload.mesh, upload.vertices.data(),
+                   static_cast<unsigned int>(upload.vertices.size()), upload.indices.data(),
+                   static_cast<unsigned int>(upload.indices.size()));
+    }
+    return static_cast<std::uint32_t>(uploads.size());
+}
+
+// Levels stop once one keeps more than this share of the level before it.
+constexpr float LOD_MIN_REDUCTION = 0.8f;
+
+MeshId makeMeshWithLods(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount,
+                        const unsigned int *indices, unsigned int indexCount) {
+    // every level goes after the previous one in a single upload, lods[0] first
+    std::vector<unsigned int> all(indices, indices + indexCount);
+    MeshLod lods[MESH_MAX_LODS];
+    lods[0] = MeshLod{0, indexCount, 0.0f};
+    unsigned int lodCount = 1;
+
+    std::vector<unsigned int> previous(indices, indices + indexCount);
+    std::vector<unsigned int> simplified;
+    float error = 0.0f;
+    while (lodCount < MESH_MAX_LODS) {
+        std::size_t target = previous.size() / 6 * 3;
+        float levelError = simplifyMesh(vertices, vertexCount, previous.data(), previous.size(),
+                                        target, std::numeric_limits<float>::max(), simplified);
+        if (simplified.empty() ||
+            (float)simplified.size() > (float)previous.size() * LOD_MIN_REDUCTION) {
+            break;
+        }
+
+        // levels are simplified from each other, so their errors add up
+        error += levelError;
+        optimizeVertexCache(simplified.data(), simplified.size(), vertexCount);
+        lods[lodCount++] = MeshLod{static_cast<unsigned int>(all.size()),
+                                   static_cast<unsigned int>(simplified.size()), error};
+        all.insert(all.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+
+    MeshId id = makeMesh(registry, vertices, vertexCount, all.data(),
+                         static_cast<unsigned int>(all.size()));
+    Mesh *m = registry.get(id);
+    unsigned int first = m->indexStart;
+    for (unsigned int lod = 0; lod < lodCount; ++lod) {
+        m->lods[lod] = lods[lod];
+        m->lods[lod].firstIndex += first;
+    }
+    m->lodCount = lodCount;
+
+    return id;
+}
+
+void destroyMeshArenas(MeshRegistry &registry) {
+    for (MeshArena &arena : registry.arenas) {
+        if (arena.VAO == 0) {
+            continue;
+        }
+        glDeleteVertexArrays(1, &arena.VAO);
+        glDeleteBuffers(1, &arena.VBO);
+        glDeleteBuffers(1, &arena.EBO);
+        arena = MeshArena{arena.format};
+    }
 }
 
 struct ObjVec3 {
@@ -86,6 +369,16 @@ struct ObjIndex {
     int v = -1;
     int vt = -1;
     int vn = -1;
+
+    bool operator==(const ObjIndex &) const = default;
+};
+
+struct ObjIndexHash {
+    std::size_t operator()(const ObjIndex &index) const {
+        std::size_t h = std::hash<int>()(index.v);
+        h = h * 31 + std::hash<int>()(index.vt);
+        return h * 31 + std::hash<int>()(index.vn);
+    }
 };
 
 int resolveIndex(int index, int count) {
@@ -148,11 +441,25 @@ Vertex makeVertex(const ObjIndex &index, const std::vector<ObjVec3> &positions,
     return v;
 }
 
-Mesh *makeMeshFromObj(std::string source) {
+bool parseObj(const std::string &source, std::vector<Vertex> &vertices,
+              std::vector<unsigned int> &indices) {
     std::vector<ObjVec3> positions;
     std::vector<ObjVec3> normals;
     std::vector<ObjVec2> uvs;
-    std::vector<Vertex> vertices;
+
+    // every distinct v/vt/vn corner becomes one vertex
+    std::unordered_map<ObjIndex, unsigned int, ObjIndexHash> corners;
+    auto addCorner = [&](const ObjIndex &index) {
+        auto [it, inserted] =
+            corners.try_emplace(index, static_cast<unsigned int>(vertices.size()));
+        if (inserted) {
+            vertices.push_back(makeVertex(index, positions, normals, uvs));
+        }
+        indices.push_back(it->second);
+    };
+
+    vertices.clear();
+    indices.clear();
 
     std::istringstream lines(source);
     std::string current;
@@ -188,17 +495,38 @@ Mesh *makeMeshFromObj(std::string source) {
             }
 
             for (size_t i = 1; i + 1 < face.size(); ++i) {
-                vertices.push_back(makeVertex(face[0], positions, normals, uvs));
-                vertices.push_back(makeVertex(face[i], positions, normals, uvs));
-                vertices.push_back(makeVertex(face[i + 1], positions, normals, uvs));
+                addCorner(face[0]);
+                addCorner(face[i]);
+                addCorner(face[i + 1]);
             }
         }
     }
 
-    if (vertices.empty()) {
+    return !indices.empty();
+}
+
+MeshId makeMeshFromObj(MeshRegistry &registry, std::string source) {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    if (!parseObj(source, vertices, indices)) {
         Log(LogLevel::ERROR, "OBJ had no faces to load");
     }
 
-    Mesh *m = makeMesh(vertices.data(), static_cast<unsigned int>(vertices.size()));
-    return m;
+    unsigned int vertexCount = static_cast<unsigned int>(vertices.size());
+    float acmrBefore = computeAcmr(indices.data(), indices.size(), vertexCount);
+    optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+    float acmrAfter = computeAcmr(indices.data(), indices.size(), vertexCount);
+
+    MeshId id = makeMeshWithLods(registry, vertices.data(), vertexCount, indices.data(),
+                                 static_cast<unsigned int>(indices.size()));
+
+    const Mesh *m = registry.get(id);
+    Log(LogLevel::INFO,
+        std::format("[Mesh] OBJ: {} triangles, {} unique vertices, ACMR {:.3f} -> {:.3f}, {} "
+                    "LOD(s), coarsest {} triangles",
+                    indices.size() / 3, vertexCount, acmrBefore, acmrAfter, m->lodCount,
+                    m->lods[m->lodCount - 1].indexCount / 3)
+            .c_str());
+
+    return id;
 }
@@ -1,23 +1,108 @@
 #ifndef MESH_H
 #define MESH_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <format>
+#include <mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "../core/logger.h"
+#include "../core/math.h"
+#include "../core/pool.h"
+#include "vertex_format.h"
 
 typedef unsigned int MeshId;
+constexpr MeshId MESH_INVALID_ID = 0xFFFFFFFF;
 
-struct Mesh {
-    unsigned int VAO, VBO, EBO = 0;
+// Model space extents, filled from the vertices when the mesh is made.
+struct MeshBounds {
+    Vector3 min{0, 0, 0};
+    Vector3 max{0, 0, 0};
+    // bounding sphere around the box center, radius reaches the farthest vertex
+    Vector3 center{0, 0, 0};
+    float radius = 0.0f;
+};
+
+// A run of vertices or indices in an arena.
+struct ArenaRange {
+    unsigned int start = 0;
+    unsigned int count = 0;
+};
+
+// Every static mesh of a vertex format lives in one vertex buffer and one index buffer behind a
+// single VAO, so switching meshes between draws is an offset instead of a VAO bind. Meshes are
+// appended, the buffers grow by copying into storage twice the size. Space left behind by a mesh
+// that moved is kept in free lists and handed out again before the arena grows.
+struct MeshArena {
+    VertexFormat format = VERTEX_FORMAT_FLOAT;
+
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+
+    unsigned int vertexCapacity = 0;
     unsigned int vertexCount = 0;
+    unsigned int indexCapacity = 0;
     unsigned int indexCount = 0;
+
+    // sorted by start, adjacent ranges are merged
+    std::vector<ArenaRange> freeVertices = {};
+    std::vector<ArenaRange> freeIndices = {};
+
+    unsigned int grows = 0;
+};
+
+// First fit. Returns false, leaving `start` alone, when no free range holds `count`.
+bool claimArenaRange(std::vector<ArenaRange> &free, unsigned int count, unsigned int &start);
+// Gives [start, start + count) back, merged with the free ranges it touches.
+void releaseArenaRange(std::vector<ArenaRange> &free, unsigned int start, unsigned int count);
+
+constexpr unsigned int MESH_MAX_LODS = 4;
+
+// One level of detail, a range of the arena's index buffer.
+struct MeshLod {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    // how far, in model units, the simplified surface strays from the full mesh
+    float error = 0.0f;
+};
+
+// A range of the registry's arena for its format. Indices are relative to the mesh, draws add
+// baseVertex. Every level of detail indexes the same vertices, lods[0] is the full mesh.
+struct Mesh {
+    VertexFormat format = VERTEX_FORMAT_FLOAT;
+    // identity for float meshes
+    VertexQuantization quantization;
+
+    unsigned int baseVertex = 0;
+    unsigned int vertexCount = 0;
+    unsigned int indexStart = 0;
+    // space claimed in the arena, updateMesh rewrites in place while the new geometry fits
+    unsigned int vertexCapacity = 0;
+    unsigned int indexCapacity = 0;
+
+    MeshLod lods[MESH_MAX_LODS];
+    unsigned int lodCount = 1;
+    MeshBounds bounds;
 };
 
 struct MeshRegistry {
     std::unordered_map<MeshId, Mesh *> meshes;
+    Pool<Mesh, 64> pool;
     MeshId current = 0;
 
+    MeshArena arenas[VERTEX_FORMAT_COUNT] = {{VERTEX_FORMAT_FLOAT}, {VERTEX_FORMAT_PACKED}};
+    // lets makeMesh store meshes as PackedVertex when they are within its tolerances
+    bool allowPacking = true;
+
+    Mesh *alloc() {
+        return pool.alloc();
+    }
+
     MeshId add(Mesh *mesh) {
         MeshId id = current++;
         meshes[id] = mesh;
@@ -28,23 +113,85 @@ struct MeshRegistry {
         return meshes.at(id);
     }
 
-    void clear() const {
+    void clear() {
         for (auto &[id, mesh] : meshes) {
-            free(mesh);
+            pool.release(mesh);
             Log(LogLevel::DEBUG, std::format("Freed mesh #{}", id).c_str());
         }
+        meshes.clear();
+
+        Log(LogLevel::DEBUG,
+            std::format("Mesh pool: {} chunk(s), {}/{} slots used, peak {}, {} allocations",
+                        pool.stats.chunks, pool.stats.used, pool.stats.capacity, pool.stats.peak,
+                        pool.stats.allocations)
+                .c_str());
     }
 };
 
-struct Vertex {
-    float px, py, pz;
-    float nx, ny, nz;
-    float u, v;
+[[nodiscard]] inline MeshBounds computeMeshBounds(const Vertex *vertices, unsigned int count) {
+    MeshBounds bounds;
+    if (count == 0) {
+        return bounds;
+    }
+
+    bounds.min = bounds.max = Vector3{vertices[0].px, vertices[0].py, vertices[0].pz};
+    for (unsigned int i = 1; i < count; ++i) {
+        const Vertex &v = vertices[i];
+        bounds.min = Vector3{std::min(bounds.min.x, v.px), std::min(bounds.min.y, v.py),
+                             std::min(bounds.min.z, v.pz)};
+        bounds.max = Vector3{std::max(bounds.max.x, v.px), std::max(bounds.max.y, v.py),
+                             std::max(bounds.max.z, v.pz)};
+    }
+
+    bounds.center = (bounds.min + bounds.max) * 0.5f;
+    float radiusSquared = 0.0f;
+    for (unsigned int i = 0; i < count; ++i) {
+        Vector3 offset = Vector3{vertices[i].px, vertices[i].py, vertices[i].pz} - bounds.center;
+        radiusSquared = std::max(radiusSquared, offset.dot(offset));
+    }
+    bounds.radius = std::sqrt(radiusSquared);
+    return bounds;
+}
+
+// Non-indexed meshes get a sequential index list, everything is drawn with
+// glDrawElements*BaseVertex. The vertex format is picked by chooseVertexFormat.
+MeshId makeMesh(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount);
+MeshId makeMesh(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount,
+                const unsigned int *indices, unsigned int indexCount);
+// Replaces the geometry of a mesh with a single LOD, the id stays the same. Rewritten in place if
+// it fits the mesh's space in the arena, otherwise moved to a free range or the end of the arena
+// and its old space is released. Needs the GL context.
+void updateMesh(MeshRegistry &registry, MeshId id, const Vertex *vertices,
+                unsigned int vertexCount, const unsigned int *indices, unsigned int indexCount);
+// Like the indexed makeMesh, plus up to MESH_MAX_LODS - 1 simplified levels that each halve the
+// triangle count, as long as simplifying still gets somewhere.
+MeshId makeMeshWithLods(MeshRegistry &registry, const Vertex *vertices, unsigned int vertexCount,
+                        const unsigned int *indices, unsigned int indexCount);
+// Triangulates the faces of an OBJ, identical v/vt/vn corners share a vertex. Returns false if it
+// had no faces.
+bool parseObj(const std::string &source, std::vector<Vertex> &vertices,
+              std::vector<unsigned int> &indices);
+// Loads an OBJ as an indexed mesh with its LODs, triangles ordered for the vertex cache.
+MeshId makeMeshFromObj(MeshRegistry &registry, std::string source);
+
+// Geometry built on another thread, waiting for the thread that owns the GL context.
+struct MeshUpload {
+    MeshId mesh;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+struct MeshUploadQueue {
+    std::mutex mutex;
+    std::vector<MeshUpload> pending;
 };
 
-Mesh *makeMesh(const Vertex *vertices, unsigned int vertexCount);
-Mesh *makeMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices,
-               unsigned int indexCount);
-Mesh *makeMeshFromObj(std::string source);
+void pushMeshUpload(MeshUploadQueue &queue, MeshUpload upload);
+// Calls updateMesh for everything pushed so far, returns how many. Needs the GL context.
+std::uint32_t applyMeshUploads(MeshUploadQueue &queue, MeshRegistry &registry);
+
+// Deletes the arenas' GL objects, needs the context current. The meshes themselves are freed by
+// MeshRegistry::clear.
+void destroyMeshArenas(MeshRegistry &registry);
 
 #endif
@@ -0,0 +1,380 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+#include "mesh_optimize.h"
+
+float computeAcmr(const unsigned int *indices, std::size_t indexCount, unsigned int vertexCount,
+                  unsigned int cacheSize) {
+    if (indexCount < 3) {
+        return 0.0f;
+    }
+
+    // a vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<std::size_t> loadedAt(vertexCount, 0);
+    std::size_t misses = 0;
+    for (std::size_t i = 0; i < indexCount; ++i) {
+        std::size_t &loaded = loadedAt[indices[i]];
+        if (loaded == 0 || misses - loaded >= cacheSize) {
+            misses++;
+            loaded = misses;
+        }
+    }
+
+    return (float)misses / (float)(indexCount / 3);
+}
+
+// Pops dead-end vertices, then scans forward, for a vertex that still has triangles left.
+static int skipDeadEnd(const std::vector<unsigned int> &live, std::vector<unsigned int> &deadEnd,
+                       unsigned int &cursor, unsigned int vertexCount) {
+    while (!deadEnd.empty()) {
+        unsigned int vertex = deadEnd.back();
+        deadEnd.pop_back();
+        if (live[vertex] > 0) {
+            return (int)vertex;
+        }
+    }
+
+    for (; cursor < vertexCount; ++cursor) {
+        if (live[cursor] > 0) {
+            return (int)cursor;
+        }
+    }
+    return -1;
+}
+
+void optimizeVertexCache(unsigned int *indices, std::size_t indexCount, unsigned int vertexCount,
+                         unsigned int cacheSize) {
+    std::size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    // triangles around each vertex, as offsets into one flat list
+    std::vector<unsigned int> live(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        live[indices[i]]++;
+    }
+
+    std::vector<unsigned int> adjacencyStart(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        adjacencyStart[v + 1] = adjacencyStart[v] + live[v];
+    }
+
+    std::vector<unsigned int> adjacency(triangleCount * 3);
+    std::vector<unsigned int> filled(adjacencyStart.begin(), adjacencyStart.end() - 1);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            adjacency[filled[indices[t * 3 + corner]]++] = (unsigned int)t;
+        }
+    }
+
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> output;
+    output.reserve(triangleCount * 3);
+
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0;
+    int fanning = skipDeadEnd(live, deadEnd, cursor, vertexCount);
+
+    while (fanning >= 0) {
+        candidates.clear();
+
+        // emit every remaining triangle around the fanning vertex
+        unsigned int vertex = (unsigned int)fanning;
+        for (unsigned int a = adjacencyStart[vertex]; a < adjacencyStart[vertex + 1]; ++a) {
+            unsigned int t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                unsigned int v = indices[t * 3 + corner];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+
+                if (time - timestamps[v] > cacheSize) {
+                    timestamps[v] = time++;
+                }
+            }
+        }
+
+        // next fan: the oldest candidate that will still be in the cache once its own
+        // triangles are emitted
+        int best = -1;
+        unsigned int bestPriority = 0;
+        for (unsigned int v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+
+            unsigned int priority = 0;
+            if (time - timestamps[v] + 2 * live[v] <= cacheSize) {
+                priority = time - timestamps[v];
+            }
+            if (best < 0 || priority > bestPriority) {
+                best = (int)v;
+                bestPriority = priority;
+            }
+        }
+
+        fanning = best >= 0 ? best : skipDeadEnd(live, deadEnd, cursor, vertexCount);
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+// Symmetric 4x4 matrix, sum of squared distances to a set of planes.
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+
+    void addPlane(double a, double b, double c, double d) {
+        a00 += a * a, a01 += a * b, a02 += a * c, a03 += a * d;
+        a11 += b * b, a12 += b * c, a13 += b * d;
+        a22 += c * c, a23 += c * d;
+        a33 += d * d;
+    }
+
+    void add(const Quadric &q) {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02, a03 += q.a03;
+        a11 += q.a11, a12 += q.a12, a13 += q.a13;
+        a22 += q.a22, a23 += q.a23;
+        a33 += q.a33;
+    }
+
+    [[nodiscard]] double evaluate(const Vertex &v) const {
+        double x = v.px, y = v.py, z = v.pz;
+        double error = a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x +
+                       a11 * y * y + 2 * a12 * y * z + 2 * a13 * y + a22 * z * z + 2 * a23 * z +
+                       a33;
+        return error > 0.0 ? error : 0.0;
+    }
+};
+
+struct Collapse {
+    double cost;
+    unsigned int from;
+    unsigned int to;
+
+    bool operator>(const Collapse &other) const {
+        return cost > other.cost;
+    }
+};
+
+static Vector3 vertexPosition(const Vertex &v) {
+    return Vector3{v.px, v.py, v.pz};
+}
+
+static Vector3 triangleNormal(Vector3 a, Vector3 b, Vector3 c) {
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+    return Vector3{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z,
+                   ab.x * ac.y - ab.y * ac.x};
+}
+
+// Marks vertices that must not move: ones sharing their position with another vertex (a seam in
+// normals or UVs) and ones on an edge used by a single triangle.
+static std::vector<bool> findLockedVertices(const Vertex *vertices, unsigned int vertexCount,
+                                            const unsigned int *indices, std::size_t indexCount) {
+    std::vector<bool> locked(vertexCount, false);
+
+    std::vector<unsigned int> order(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        order[v] = v;
+    }
+    auto byPosition = [&](unsigned int a, unsigned int b) {
+        const Vertex &va = vertices[a];
+        const Vertex &vb = vertices[b];
+        return std::tie(va.px, va.py, va.pz) < std::tie(vb.px, vb.py, vb.pz);
+    };
+    std::sort(order.begin(), order.end(), byPosition);
+    for (unsigned int i = 1; i < vertexCount; ++i) {
+        if (!byPosition(order[i - 1], order[i])) {
+            locked[order[i - 1]] = true;
+            locked[order[i]] = true;
+        }
+    }
+
+    // an edge is on the border when its reverse isn't used by any triangle
+    std::vector<std::uint64_t> edges;
+    edges.reserve(indexCount);
+    for (std::size_t t = 0; t + 2 < indexCount; t += 3) {
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            std::uint64_t a = indices[t + corner];
+            std::uint64_t b = indices[t + (corner + 1) % 3];
+            edges.push_back((a << 32) | b);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (std::uint64_t edge : edges) {
+        std::uint64_t reverse = (edge << 32) | (edge >> 32);
+        if (!std::binary_search(edges.begin(), edges.end(), reverse)) {
+            locked[edge >> 32] = true;
+            locked[edge & 0xFFFFFFFF] = true;
+        }
+    }
+
+    return locked;
+}
+
+float simplifyMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices,
+                   std::size_t indexCount, std::size_t targetIndexCount, float maxError,
+                   std::vector<unsigned int> &out) {
+    std::size_t triangleCount = indexCount / 3;
+    std::vector<unsigned int> working(indices, indices + triangleCount * 3);
+    std::vector<bool> locked = findLockedVertices(vertices, vertexCount, indices, indexCount);
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::vector<unsigned int>> triangles(vertexCount);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        unsigned int a = working[t * 3], b = working[t * 3 + 1], c = working[t * 3 + 2];
+        Vector3 normal = triangleNormal(vertexPosition(vertices[a]), vertexPosition(vertices[b]),
+                                        vertexPosition(vertices[c]))
+                             .normalized();
+        double d = -normal.dot(vertexPosition(vertices[a]));
+        for (unsigned int v : {a, b, c}) {
+            quadrics[v].addPlane(normal.x, normal.y, normal.z, d);
+            triangles[v].push_back((unsigned int)t);
+        }
+    }
+
+    std::vector<bool> dead(triangleCount, false);
+    std::vector<unsigned int> remap(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        remap[v] = v;
+    }
+
+    auto cost = [&](unsigned int from, unsigned int to) {
+        Quadric q = quadrics[from];
+        q.add(quadrics[to]);
+        return q.evaluate(vertices[to]);
+    };
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+    auto pushEdges = [&](unsigned int v) {
+        for (unsigned int t : triangles[v]) {
+            if (dead[t]) {
+                continue;
+            }
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                unsigned int w = working[t * 3 + corner];
+                if (w == v) {
+                    continue;
+                }
+                if (!locked[v]) {
+                    heap.push(Collapse{cost(v, w), v, w});
+                }
+                if (!locked[w]) {
+                    heap.push(Collapse{cost(w, v), w, v});
+                }
+            }
+        }
+    };
+    for (unsigned int v = 0; v < vertexCount; ++v) {
+        pushEdges(v);
+    }
+
+    // a collapse must not turn any remaining triangle around `from` over
+    auto flips = [&](unsigned int from, unsigned int to) {
+        Vector3 moved = vertexPosition(vertices[to]);
+        for (unsigned int t : triangles[from]) {
+            if (dead[t]) {
+                continue;
+            }
+            Vector3 corners[3];
+            Vector3 after[3];
+            bool hasTo = false;
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                unsigned int w = working[t * 3 + corner];
+                hasTo |= w == to;
+                corners[corner] = vertexPosition(vertices[w]);
+                after[corner] = w == from ? moved : corners[corner];
+            }
+            if (hasTo) {
+                continue; // collapses away
+            }
+            Vector3 before = triangleNormal(corners[0], corners[1], corners[2]);
+            if (before.dot(triangleNormal(after[0], after[1], after[2])) <= 0.0f) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::size_t live = triangleCount;
+    double limit = (double)maxError * maxError;
+    double largest = 0.0;
+
+    while (live * 3 > targetIndexCount && !heap.empty()) {
+        Collapse collapse = heap.top();
+        heap.pop();
+
+        unsigned int from = collapse.from;
+        unsigned int to = collapse.to;
+        if (remap[from] != from || remap[to] != to) {
+            continue;
+        }
+
+        // quadrics grew since this was queued, requeue at the current cost
+        double current = cost(from, to);
+        if (current > collapse.cost * (1.0 + 1e-6) + 1e-12) {
+            heap.push(Collapse{current, from, to});
+            continue;
+        }
+        if (current > limit) {
+            break;
+        }
+        if (flips(from, to)) {
+            continue;
+        }
+
+        remap[from] = to;
+        quadrics[to].add(quadrics[from]);
+        largest = std::max(largest, current);
+
+        for (unsigned int t : triangles[from]) {
+            if (dead[t]) {
+                continue;
+            }
+            unsigned int *corners = &working[t * 3];
+            for (std::size_t corner = 0; corner < 3; ++corner) {
+                if (corners[corner] == from) {
+                    corners[corner] = to;
+                }
+            }
+            if (corners[0] == corners[1] || corners[1] == corners[2] ||
+                corners[0] == corners[2]) {
+                dead[t] = true;
+                live--;
+            } else {
+                triangles[to].push_back(t);
+            }
+        }
+        triangles[from].clear();
+
+        pushEdges(to);
+    }
+
+    out.clear();
+    out.reserve(live * 3);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        if (!dead[t]) {
+            out.insert(out.end(), &working[t * 3], &working[t * 3] + 3);
+        }
+    }
+
+    return (float)std::sqrt(largest);
+}
@@ -0,0 +1,33 @@
+#ifndef MESH_OPTIMIZE_H
+#define MESH_OPTIMIZE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "vertex_format.h"
+
+// Entries of the post-transform vertex cache assumed when ordering and measuring, a FIFO of this
+// size is close enough to what current GPUs do.
+constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+// Average cache miss ratio: transformed vertices per triangle with a FIFO cache of `cacheSize`.
+// 3 is no reuse at all, a regular grid approaches 0.5.
+[[nodiscard]] float computeAcmr(const unsigned int *indices, std::size_t indexCount,
+                                unsigned int vertexCount,
+                                unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// Reorders the triangles in place for vertex cache locality (Tipsify, Sander et al. 2007).
+// Triangles keep their winding, only their order changes.
+void optimizeVertexCache(unsigned int *indices, std::size_t indexCount, unsigned int vertexCount,
+                         unsigned int cacheSize = VERTEX_CACHE_SIZE);
+
+// Quadric error edge collapse (Garland and Heckbert 1997) down to about `targetIndexCount`
+// indices, stopping early if the next collapse would move the surface more than `maxError` model
+// units. Vertices are only merged into each other, so `out` indexes the same vertex buffer.
+// Vertices on open borders and attribute seams are kept in place. Returns the largest error of
+// any collapse that was made.
+float simplifyMesh(const Vertex *vertices, unsigned int vertexCount, const unsigned int *indices,
+                   std::size_t indexCount, std::size_t targetIndexCount, float maxError,
+                   std::vector<unsigned int> &out);
+
+#endif
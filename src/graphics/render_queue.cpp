@@ -0,0 +1,68 @@
+#include <bit>
+#include <cstring>
+#include <utility>
+
+#include "../core/assert.h"
+#include "render_queue.h"
+
+std::uint64_t makeRenderKey(RenderPass pass, unsigned int shader, MeshId mesh, unsigned int lod,
+                            float depth) {
+    ASSERT(shader < (1u << RENDER_KEY_SHADER_BITS));
+    ASSERT(mesh < (1u << RENDER_KEY_MESH_BITS));
+    ASSERT(lod < (1u << RENDER_KEY_LOD_BITS));
+
+    std::uint32_t depthBits = std::bit_cast<std::uint32_t>(depth < 0.0f ? 0.0f : depth);
+    if (pass == RENDER_PASS_TRANSPARENT) {
+        depthBits = ~depthBits;
+    }
+
+    return (static_cast<std::uint64_t>(pass) << 60) | (static_cast<std::uint64_t>(shader) << 50) |
+           (static_cast<std::uint64_t>(mesh) << 34) | (static_cast<std::uint64_t>(lod) << 32) |
+           depthBits;
+}
+
+void sortRenderQueue(RenderQueue &queue) {
+    std::size_t count = queue.packets.size();
+    if (count < 2) {
+        return;
+    }
+
+    // all eight histograms in one read of the keys
+    std::uint32_t histograms[8][256];
+    std::memset(histograms, 0, sizeof(histograms));
+    for (const RenderPacket &packet : queue.packets) {
+        for (int digit = 0; digit < 8; ++digit) {
+            histograms[digit][(packet.key >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    queue.scratch.resize(count);
+    RenderPacket *source = queue.packets.data();
+    RenderPacket *destination = queue.scratch.data();
+
+    for (int digit = 0; digit < 8; ++digit) {
+        std::uint32_t *histogram = histograms[digit];
+
+        // every key has the same byte here, the pass would not move anything
+        std::uint8_t first = (source[0].key >> (digit * 8)) & 0xFF;
+        if (histogram[first] == count) {
+            continue;
+        }
+
+        std::uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; ++bucket) {
+            std::uint32_t size = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += size;
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            destination[histogram[(source[i].key >> (digit * 8)) & 0xFF]++] = source[i];
+        }
+        std::swap(source, destination);
+    }
+
+    if (source != queue.packets.data()) {
+        queue.packets.swap(queue.scratch);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mesh.h"
+
+// Draw packets carry a 64-bit key that encodes everything the draw order depends on, so sorting
+// the keys groups packets by GL state and orders them within a group. From the top bit down:
+//
+//   pass    4 bits   opaque before transparent
+//   shader 10 bits   program object
+//   mesh   16 bits   MeshId
+//   lod     2 bits   level of detail of the mesh
+//   depth  32 bits   squared view distance as float bits, front to back (back to front for
+//                    transparent)
+//
+// Non-negative floats order the same as their bit patterns, so depth needs no conversion.
+
+enum RenderPass : std::uint8_t {
+    RENDER_PASS_OPAQUE,
+    RENDER_PASS_TRANSPARENT,
+};
+
+constexpr unsigned int RENDER_KEY_DEPTH_BITS = 32;
+constexpr unsigned int RENDER_KEY_LOD_BITS = 2;
+constexpr unsigned int RENDER_KEY_MESH_BITS = 16;
+constexpr unsigned int RENDER_KEY_SHADER_BITS = 10;
+
+// Everything but depth, packets with equal state can share one draw.
+constexpr unsigned int RENDER_KEY_STATE_SHIFT = RENDER_KEY_DEPTH_BITS;
+
+[[nodiscard]] std::uint64_t makeRenderKey(RenderPass pass, unsigned int shader, MeshId mesh,
+                                          unsigned int lod, float depth);
+
+[[nodiscard]] constexpr RenderPass renderKeyPass(std::uint64_t key) {
+    return static_cast<RenderPass>(key >> 60);
+}
+
+[[nodiscard]] constexpr unsigned int renderKeyShader(std::uint64_t key) {
+    return static_cast<unsigned int>(key >> 50) & ((1u << RENDER_KEY_SHADER_BITS) - 1);
+}
+
+[[nodiscard]] constexpr MeshId renderKeyMesh(std::uint64_t key) {
+    return static_cast<MeshId>(key >> 34) & ((1u << RENDER_KEY_MESH_BITS) - 1);
+}
+
+[[nodiscard]] constexpr unsigned int renderKeyLod(std::uint64_t key) {
+    return static_cast<unsigned int>(key >> 32) & ((1u << RENDER_KEY_LOD_BITS) - 1);
+}
+
+struct RenderPacket {
+    std::uint64_t key;
+    std::uint32_t item; // caller's index for the packet payload
+};
+
+struct RenderQueue {
+    std::vector<RenderPacket> packets;
+    // radix sort ping-pong buffer
+    std::vector<RenderPacket> scratch;
+};
+
+inline void clearRenderQueue(RenderQueue &queue) {
+    queue.packets.clear();
+}
+
+inline void pushRenderPacket(RenderQueue &queue, std::uint64_t key, std::uint32_t item) {
+    queue.packets.push_back(RenderPacket{key, item});
+}
+
+// Stable LSD radix sort on the keys, a byte per pass. Bytes that are the same in every key (most
+// of them, with one shader and a few meshes) are skipped.
+void sortRenderQueue(RenderQueue &queue);
+
+#endif
@@ -0,0 +1,108 @@
+#include <format>
+#include <utility>
+#include <vector>
+
+#include "../core/logger.h"
+#include "renderer.h"
+
+static void renderMain(RenderThread *renderer) {
+    Platform *platform = renderer->platform;
+    platform->api.makeContextCurrent(platform, true);
+
+    Profiler &profiler = renderer->profiler;
+    std::uint32_t drawScope = addProfileScope(profiler, "draw");
+    std::uint32_t swapScope = addProfileScope(profiler, "swap");
+    std::uint32_t gpuEntitiesScope = addProfileScope(profiler, "gpu_entities");
+    if (!renderer->profilePath.empty()) {
+        openProfileCsv(profiler, renderer->profilePath.c_str());
+    }
+    initGpuTimers(renderer->gpuTimers);
+
+    // the snapshot before the one being drawn, swapped out of the triple buffer's read slot
+    RenderSnapshot previous;
+    std::vector<Vector3> previousPositions;
+    std::vector<std::uint32_t> sparse;
+
+    bool hasSnapshot = false;
+
+    while (renderer->running.load(std::memory_order_acquire)) {
+        if (renderer->snapshots.hasNew()) {
+            std::swap(previous, renderer->snapshots.readBuffer());
+            renderer->snapshots.acquire();
+
+            matchPreviousPositions(previous, renderer->snapshots.readBuffer(), sparse,
+                                   previousPositions);
+            hasSnapshot = true;
+        }
+
+        if (!hasSnapshot) {
+            platform->api.sleepMs(platform, 1);
+            continue;
+        }
+
+        const RenderSnapshot &current = renderer->snapshots.readBuffer();
+
+        // the simulation keeps ticking while we draw, advance alpha by the time since publish
+        double now = platform->api.getTimeSeconds(platform);
+        double alpha = current.alpha + (now - current.publishTime) / current.tickDelta;
+        if (alpha > 1.0) {
+            alpha = 1.0;
+        }
+
+        collectGpuTimers(renderer->gpuTimers, profiler);
+        beginProfileFrame(profiler);
+
+        applyMeshUploads(renderer->uploads, *renderer->registry);
+
+        beginProfileScope(profiler, drawScope);
+        beginGpuScope(renderer->gpuTimers, profiler, gpuEntitiesScope);
+        drawEntities(current, previousPositions, (float)alpha, renderer->shaderProgram,
+                     *renderer->registry, renderer->entities);
+        endGpuScope(renderer->gpuTimers);
+        endProfileScope(profiler, drawScope);
+
+        beginProfileScope(profiler, swapScope);
+        platform->api.swapBuffers(platform);
+        endProfileScope(profiler, swapScope);
+
+        renderer->framesDrawn.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // the last frames' queries may still be in flight
+    finishGpuTimers(renderer->gpuTimers, profiler);
+    closeProfiler(profiler);
+    shutdownGpuTimers(renderer->gpuTimers);
+
+    platform->api.makeContextCurrent(platform, false);
+}
+
+void startRenderThread(RenderThread &renderer, Platform *platform, MeshRegistry &registry,
+                       unsigned int shaderProgram) {
+    renderer.platform = platform;
+    renderer.registry = &registry;
+    renderer.shaderProgram = shaderProgram;
+
+    renderer.running = true;
+    renderer.thread = std::thread(renderMain, &renderer);
+
+    Log(LogLevel::DEBUG, "[Renderer] Render thread started");
+}
+
+void stopRenderThread(RenderThread &renderer) {
+    renderer.running = false;
+    if (renderer.thread.joinable()) {
+        renderer.thread.join();
+    }
+
+    const RenderStats &stats = renderer.entities.stats;
+    Log(LogLevel::DEBUG,
+        std::format("[Renderer] Render thread stopped after {} frames",
+                    renderer.framesDrawn.load())
+            .c_str());
+    Log(LogLevel::DEBUG,
+        std::format("[Renderer] {} packets, {} culled, {} draws, {} state changes, {} skipped",
+                    stats.packets, stats.culled, stats.draws, stats.stateChanges,
+                    stats.stateChangesSkipped)
+            .c_str());
+    logProfileStats(renderer.profiler, "render");
+}
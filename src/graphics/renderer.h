@@ -0,0 +1,48 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "../core/profiler.h"
+#include "../core/triple_buffer.h"
+#include "../platform/platform.h"
+#include "gpu_timer.h"
+#include "graphics.h"
+#include "mesh.h"
+
+// Owns the GL context on a dedicated thread. The simulation publishes RenderSnapshots into
+// `snapshots`, the render thread draws the newest one interpolated against the one before it, so
+// a slow frame never delays a tick and a slow tick never stalls presenting.
+struct RenderThread {
+    std::thread thread;
+    std::atomic<bool> running{false};
+
+    TripleBuffer<RenderSnapshot> snapshots;
+
+    Platform *platform = nullptr;
+    MeshRegistry *registry = nullptr;
+    unsigned int shaderProgram = 0;
+
+    std::atomic<std::uint64_t> framesDrawn{0};
+
+    // geometry rebuilt on other threads, uploaded by the render thread before its next frame
+    MeshUploadQueue uploads;
+
+    // per-frame timings written here when not empty, set before starting the thread
+    std::string profilePath;
+
+    // only touched by the render thread while it runs
+    EntityRenderer entities;
+    Profiler profiler;
+    GpuTimers gpuTimers;
+};
+
+// The caller must not have the GL context current, the render thread takes it over until
+// stopRenderThread returns.
+void startRenderThread(RenderThread &renderer, Platform *platform, MeshRegistry &registry,
+                       unsigned int shaderProgram);
+void stopRenderThread(RenderThread &renderer);
+
+#endif
@@ -0,0 +1,209 @@
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../core/file.h"
+#include "../core/logger.h"
+#include "opengl.h"
+#include "shader.h"
+
+static constexpr std::uint32_t SHADER_CACHE_MAGIC = 0x52444853; // "SHDR"
+static constexpr std::uint32_t SHADER_CACHE_VERSION = 1;
+
+struct ShaderCacheHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t format; // GLenum reported by glGetProgramBinary
+    std::uint32_t length;
+};
+
+static void hashString(std::uint64_t &hash, const char *text) {
+    for (const char *c = text; *c != '\0'; ++c) {
+        hash ^= static_cast<unsigned char>(*c);
+        hash *= 0x100000001B3ull;
+    }
+    // separator, so "ab" + "c" and "a" + "bc" differ
+    hash ^= 0xFF;
+    hash *= 0x100000001B3ull;
+}
+
+static const char *glString(GLenum name) {
+    const GLubyte *value = glGetString(name);
+    return value != nullptr ? reinterpret_cast<const char *>(value) : "";
+}
+
+static std::uint64_t shaderCacheKey(const std::string &vertexSource,
+                                    const std::string &fragmentSource) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    hashString(hash, vertexSource.c_str());
+    hashString(hash, fragmentSource.c_str());
+    // a binary is only valid for the driver that produced it
+    hashString(hash, glString(GL_VENDOR));
+    hashString(hash, glString(GL_RENDERER));
+    hashString(hash, glString(GL_VERSION));
+    return hash;
+}
+
+static bool supportsProgramBinaries() {
+    // on contexts without ARB_get_program_binary this is an invalid enum and stays 0
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    glGetError();
+    return formats > 0;
+}
+
+static unsigned int loadCachedProgram(const std::string &path, std::uint64_t key) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    ShaderCacheHeader header{};
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        header.magic != SHADER_CACHE_MAGIC || header.version != SHADER_CACHE_VERSION ||
+        header.key != key) {
+        return 0;
+    }
+
+    std::vector<char> binary(header.length);
+    if (!file.read(binary.data(), (std::streamsize)binary.size())) {
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, static_cast<GLenum>(header.format), binary.data(),
+                    (GLsizei)binary.size());
+
+    // drivers are allowed to reject binaries they produced themselves, e.g. after an update
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+static void storeCachedProgram(const std::string &directory, const std::string &path,
+                               unsigned int program, std::uint64_t key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    std::vector<char> binary((std::size_t)length);
+    GLenum format;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    // written next to the target and renamed, a half written cache file never gets loaded
+    std::string temporary = path + ".tmp";
+    bool written = true;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        ShaderCacheHeader header{SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, key,
+                                 static_cast<std::uint32_t>(format),
+                                 static_cast<std::uint32_t>(length)};
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), length);
+        if (!file) {
+            Log(LogLevel::WARNING,
+                std::format("[Shader] Could not write program cache {}", temporary).c_str());
+            written = false;
+        }
+    }
+    if (!written) {
+        std::filesystem::remove(temporary, error);
+        return;
+    }
+
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        Log(LogLevel::WARNING,
+            std::format("[Shader] Could not move program cache into place at {}: {}", path,
+                        error.message())
+                .c_str());
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+static unsigned int compileShader(GLenum type, const char *path, const std::string &source) {
+    unsigned int shader = glCreateShader(type);
+    const char *text = source.c_str();
+    glShaderSource(shader, 1, &text, NULL);
+    glCompileShader(shader);
+
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        Log(LogLevel::FATAL, std::format("{} failed to compile: {}", path, infoLog).c_str());
+    }
+    return shader;
+}
+
+unsigned int loadShaderProgram(const char *vertexPath, const char *fragmentPath,
+                               const char *cacheDirectory) {
+    std::string vertexSource;
+    std::string fragmentSource;
+    if (!readTextFile(vertexPath, vertexSource) || !readTextFile(fragmentPath, fragmentSource)) {
+        Log(LogLevel::FATAL, std::format("[Shader] Could not read {} or {}", vertexPath,
+                                         fragmentPath)
+                                 .c_str());
+        return 0;
+    }
+
+    bool cacheable = supportsProgramBinaries();
+    std::uint64_t key = shaderCacheKey(vertexSource, fragmentSource);
+    std::string cachePath = std::format("{}/{:016x}.bin", cacheDirectory, key);
+
+    if (cacheable) {
+        unsigned int program = loadCachedProgram(cachePath, key);
+        if (program != 0) {
+            Log(LogLevel::DEBUG, std::format("[Shader] {} + {} loaded from cache", vertexPath,
+                                             fragmentPath)
+                                     .c_str());
+            return program;
+        }
+    }
+
+    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertexPath, vertexSource);
+    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentPath, fragmentSource);
+
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    if (cacheable) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 1);
+    }
+    glLinkProgram(program);
+
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        Log(LogLevel::FATAL, std::format("Failed to link shader program: {}", infoLog).c_str());
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    if (cacheable) {
+        storeCachedProgram(cacheDirectory, cachePath, program, key);
+    }
+
+    Log(LogLevel::DEBUG,
+        std::format("[Shader] {} + {} compiled", vertexPath, fragmentPath).c_str());
+    return program;
+}
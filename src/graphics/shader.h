@@ -0,0 +1,13 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+// Shader programs are built from GLSL files on disk. When the driver supports program binaries
+// the linked result is cached in `cacheDirectory`, keyed by a hash of the sources and the driver
+// (vendor, renderer, version), so a warm start skips compiling altogether and any change to
+// either falls back to a fresh compile.
+
+// Returns 0 and logs when the files can't be read or the program doesn't build.
+[[nodiscard]] unsigned int loadShaderProgram(const char *vertexPath, const char *fragmentPath,
+                                             const char *cacheDirectory);
+
+#endif
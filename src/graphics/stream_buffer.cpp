@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+#include "../core/assert.h"
+#include "../core/logger.h"
+#include "stream_buffer.h"
+
+static std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool hasExtension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const char *extension =
+            reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, (GLuint)i));
+        if (extension && std::strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void createStorage(StreamBuffer &stream) {
+    GLsizeiptr size = (GLsizeiptr)(stream.regionSize * STREAM_FRAMES);
+
+    glGenBuffers(1, &stream.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+    if (stream.persistent) {
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr,
+                        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+        stream.mapped = static_cast<std::uint8_t *>(
+            glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size,
+                             GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT));
+        ASSERT(stream.mapped != nullptr);
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+static void destroyStorage(StreamBuffer &stream) {
+    if (stream.mapped) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        stream.mapped = nullptr;
+    }
+    glDeleteBuffers(1, &stream.buffer);
+    stream.buffer = 0;
+
+    for (GLsync &fence : stream.fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+// Replaces the buffer with one whose regions hold at least `size` bytes more than the current
+// frame used. The old buffer is deleted right away, GL keeps it alive for draws still reading it,
+// and the new one has no readers, so the fences go with it.
+static void growStream(StreamBuffer &stream, std::size_t size) {
+    std::size_t regionSize =
+        alignUp(std::max(stream.regionSize * 2, stream.head + size), stream.uniformAlignment);
+
+    Log(LogLevel::INFO, std::format("[Stream] Growing regions from {} KB to {} KB",
+                                    stream.regionSize / 1024, regionSize / 1024)
+                            .c_str());
+
+    destroyStorage(stream);
+    stream.regionSize = regionSize;
+    stream.head = 0;
+    stream.grows++;
+    createStorage(stream);
+}
+
+void initStreamBuffer(StreamBuffer &stream, std::size_t regionSize) {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    stream.uniformAlignment = std::max<std::size_t>((std::size_t)alignment, 16);
+
+    // every region starts where a uniform block may
+    stream.regionSize = alignUp(regionSize, stream.uniformAlignment);
+    stream.persistent = hasExtension("GL_ARB_buffer_storage");
+    stream.region = 0;
+    stream.head = 0;
+    createStorage(stream);
+
+    Log(LogLevel::INFO,
+        std::format("[Stream] {} x {} KB, {}", STREAM_FRAMES, stream.regionSize / 1024,
+                    stream.persistent ? "persistently mapped" : "unsynchronized map per upload")
+            .c_str());
+}
+
+void shutdownStreamBuffer(StreamBuffer &stream) {
+    destroyStorage(stream);
+
+    Log(LogLevel::INFO,
+        std::format("[Stream] {} frames, peak {} of {} KB per frame, {} stalls, {} grows",
+                    stream.frames, stream.peak / 1024, stream.regionSize / 1024, stream.stalls,
+                    stream.grows)
+            .c_str());
+}
+
+void beginStreamFrame(StreamBuffer &stream) {
+    stream.region = (std::uint32_t)(stream.frames % STREAM_FRAMES);
+    stream.head = 0;
+
+    GLsync &fence = stream.fences[stream.region];
+    if (!fence) {
+        return;
+    }
+
+    // normally signaled long ago, only a GPU that is STREAM_FRAMES frames behind blocks here
+    GLenum status = glClientWaitSync(fence, GL_NONE_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        stream.stalls++;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    if (status == GL_WAIT_FAILED) {
+        Log(LogLevel::ERROR, "[Stream] Waiting on a frame fence failed");
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void endStreamFrame(StreamBuffer &stream) {
+    ASSERT(!stream.fences[stream.region]);
+
+    stream.fences[stream.region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT);
+    stream.frames++;
+}
+
+std::size_t allocStream(StreamBuffer &stream, std::size_t size, std::size_t alignment) {
+    std::size_t offset = alignUp(stream.head, alignment);
+    if (offset + size > stream.regionSize) {
+        return STREAM_NO_SPACE;
+    }
+
+    stream.head = offset + size;
+    stream.peak = std::max(stream.peak, stream.head);
+    return stream.region * stream.regionSize + offset;
+}
+
+void reserveStream(StreamBuffer &stream, std::size_t size) {
+    if (stream.head + size > stream.regionSize) {
+        growStream(stream, size);
+    }
+}
+
+std::size_t uploadStream(StreamBuffer &stream, const void *data, std::size_t size,
+                         std::size_t alignment) {
+    std::size_t offset = allocStream(stream, size, alignment);
+    if (offset == STREAM_NO_SPACE) {
+        growStream(stream, size + alignment);
+        offset = allocStream(stream, size, alignment);
+        ASSERT(offset != STREAM_NO_SPACE);
+    }
+    if (size == 0) {
+        return offset;
+    }
+
+    if (stream.persistent) {
+        std::memcpy(stream.mapped + offset, data, size);
+        return offset;
+    }
+
+    // the fence of this region has been waited on, nothing can be reading the range
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream.buffer);
+    void *range = glMapBufferRange(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size,
+                                   GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+                                       GL_MAP_INVALIDATE_RANGE_BIT);
+    ASSERT(range != nullptr);
+    std::memcpy(range, data, size);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    return offset;
+}
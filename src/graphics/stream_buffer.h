@@ -0,0 +1,71 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "opengl.h"
+
+// Streaming allocator for data that is rewritten every frame, instance matrices and uniform
+// blocks. One buffer is split into STREAM_FRAMES regions and frame n writes region
+// n % STREAM_FRAMES. A fence is placed after the frame's last draw and waited on before the
+// region is reused, so the CPU never writes over anything the GPU may still read, and writes go
+// straight into the buffer without the driver orphaning or synchronizing anything.
+//
+// With GL_ARB_buffer_storage the buffer is mapped once, persistent and coherent, and an upload is
+// a memcpy. Our contexts are 3.3 core, where it is optional, so without it every upload maps just
+// its range with GL_MAP_UNSYNCHRONIZED_BIT, which is safe for the same reason.
+
+constexpr std::uint32_t STREAM_FRAMES = 3;
+constexpr std::size_t STREAM_NO_SPACE = std::numeric_limits<std::size_t>::max();
+
+struct StreamBuffer {
+    unsigned int buffer = 0;
+    bool persistent = false;
+    // whole buffer, persistent only
+    std::uint8_t *mapped = nullptr;
+
+    std::size_t regionSize = 0;
+    // region written this frame and how much of it is used
+    std::uint32_t region = 0;
+    std::size_t head = 0;
+    GLsync fences[STREAM_FRAMES] = {};
+
+    // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    std::size_t uniformAlignment = 256;
+
+    std::uint64_t frames = 0;
+    // fences that were not signaled yet when their region came around again
+    std::uint64_t stalls = 0;
+    std::uint32_t grows = 0;
+    std::size_t peak = 0;
+};
+
+// Needs the GL context current.
+void initStreamBuffer(StreamBuffer &stream, std::size_t regionSize);
+void shutdownStreamBuffer(StreamBuffer &stream);
+
+// Moves to the next region, waiting for the GPU to be done with it if it isn't yet.
+void beginStreamFrame(StreamBuffer &stream);
+// Fences everything drawn since beginStreamFrame.
+void endStreamFrame(StreamBuffer &stream);
+
+// Reserves `size` bytes of the current region at a multiple of `alignment` (a power of two) and
+// returns their offset in the buffer, or STREAM_NO_SPACE when the region is full. Doesn't touch
+// GL.
+[[nodiscard]] std::size_t allocStream(StreamBuffer &stream, std::size_t size,
+                                      std::size_t alignment);
+
+// Makes sure `size` more bytes fit the current region, padding included. When they don't the
+// buffer is replaced by one with twice the room, which drops everything uploaded this frame, so
+// call it before the frame's first upload with everything the frame needs. After the first few
+// frames nothing is allocated any more.
+void reserveStream(StreamBuffer &stream, std::size_t size);
+
+// Copies `data` into the current region and returns its offset in the buffer. Grows like
+// reserveStream if it doesn't fit.
+std::size_t uploadStream(StreamBuffer &stream, const void *data, std::size_t size,
+                         std::size_t alignment);
+
+#endif
@@ -0,0 +1,77 @@
+#include <cmath>
+
+#include "vertex_format.h"
+
+static void positionBounds(const Vertex *vertices, unsigned int count, Vector3 &min,
+                           Vector3 &max) {
+    min = max = Vector3{vertices[0].px, vertices[0].py, vertices[0].pz};
+    for (unsigned int i = 1; i < count; ++i) {
+        const Vertex &v = vertices[i];
+        min = Vector3{std::min(min.x, v.px), std::min(min.y, v.py), std::min(min.z, v.pz)};
+        max = Vector3{std::max(max.x, v.px), std::max(max.y, v.py), std::max(max.z, v.pz)};
+    }
+}
+
+VertexFormat chooseVertexFormat(const Vertex *vertices, unsigned int count) {
+    if (count == 0) {
+        return VERTEX_FORMAT_FLOAT;
+    }
+
+    // rounding to the nearest of 65536 steps is off by at most half a step
+    Vector3 min, max;
+    positionBounds(vertices, count, min, max);
+    float extent = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+    if (extent / 65535.0f * 0.5f > PACKED_POSITION_TOLERANCE) {
+        return VERTEX_FORMAT_FLOAT;
+    }
+
+    // halfs keep 11 significant bits: integer UVs are exact up to 2048, so the dungeon's world
+    // space UVs pack, but fractional UVs far from 0 lose more than the tolerance
+    for (unsigned int i = 0; i < count; ++i) {
+        const Vertex &v = vertices[i];
+        if (std::abs(halfToFloat(floatToHalf(v.u)) - v.u) > PACKED_UV_TOLERANCE ||
+            std::abs(halfToFloat(floatToHalf(v.v)) - v.v) > PACKED_UV_TOLERANCE) {
+            return VERTEX_FORMAT_FLOAT;
+        }
+    }
+
+    return VERTEX_FORMAT_PACKED;
+}
+
+static std::uint16_t quantize(float value, float offset, float scale) {
+    float normalized = scale > 0.0f ? (value - offset) / scale : 0.0f;
+    return static_cast<std::uint16_t>(std::round(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f));
+}
+
+VertexQuantization packVertices(const Vertex *vertices, unsigned int count, PackedVertex *out) {
+    VertexQuantization quantization;
+    if (count == 0) {
+        return quantization;
+    }
+
+    Vector3 min, max;
+    positionBounds(vertices, count, min, max);
+    quantization.offset = min;
+    quantization.scale = max - min;
+
+    for (unsigned int i = 0; i < count; ++i) {
+        const Vertex &v = vertices[i];
+        PackedVertex &p = out[i];
+
+        p.px = quantize(v.px, min.x, quantization.scale.x);
+        p.py = quantize(v.py, min.y, quantization.scale.y);
+        p.pz = quantize(v.pz, min.z, quantization.scale.z);
+        p.padding = 0;
+        octEncode(Vector3{v.nx, v.ny, v.nz}, p.nx, p.ny);
+        p.u = floatToHalf(v.u);
+        p.v = floatToHalf(v.v);
+    }
+
+    return quantization;
+}
+
+Vector3 unpackPosition(const PackedVertex &vertex, const VertexQuantization &quantization) {
+    return Vector3{quantization.offset.x + vertex.px / 65535.0f * quantization.scale.x,
+                   quantization.offset.y + vertex.py / 65535.0f * quantization.scale.y,
+                   quantization.offset.z + vertex.pz / 65535.0f * quantization.scale.z};
+}
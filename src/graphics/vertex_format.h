@@ -0,0 +1,140 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+#include "../core/math.h"
+
+struct Vertex {
+    float px, py, pz;
+    float nx, ny, nz;
+    float u, v;
+};
+
+// Half the size of Vertex. Positions are unorm16 inside the mesh's bounding box and decoded with
+// a per-mesh scale and offset, normals are octahedral snorm16 and UVs half floats.
+struct PackedVertex {
+    std::uint16_t px, py, pz;
+    std::uint16_t padding; // keeps the normal 4-byte aligned
+    std::int16_t nx, ny;
+    std::uint16_t u, v;
+};
+
+enum VertexFormat : std::uint8_t {
+    VERTEX_FORMAT_FLOAT,
+    VERTEX_FORMAT_PACKED,
+    VERTEX_FORMAT_COUNT,
+};
+
+// Decodes a packed position: offset + q / 65535 * scale.
+struct VertexQuantization {
+    Vector3 scale{1, 1, 1};
+    Vector3 offset{0, 0, 0};
+};
+
+// Packing has to stay within these, otherwise the mesh keeps full floats. Positions are allowed
+// an error of a fraction of a tile, UVs need texel accuracy on a 1024 texture.
+constexpr float PACKED_POSITION_TOLERANCE = 1.0f / 128.0f;
+constexpr float PACKED_UV_TOLERANCE = 1.0f / 1024.0f;
+
+[[nodiscard]] inline std::uint32_t vertexStride(VertexFormat format) {
+    return format == VERTEX_FORMAT_PACKED ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+// Round to nearest even, out of range values become infinity.
+[[nodiscard]] inline std::uint16_t floatToHalf(float value) {
+    std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+    std::uint32_t sign = (bits >> 16) & 0x8000;
+    std::uint32_t exponent = (bits >> 23) & 0xFF;
+    std::uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponent == 0xFF) {
+        return static_cast<std::uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+
+    int rebased = static_cast<int>(exponent) - 127 + 15;
+    if (rebased >= 31) {
+        return static_cast<std::uint16_t>(sign | 0x7C00);
+    }
+
+    std::uint32_t shift = 13;
+    std::uint32_t half;
+    if (rebased <= 0) {
+        // denormal, the implicit bit becomes part of the mantissa
+        if (rebased < -10) {
+            return static_cast<std::uint16_t>(sign);
+        }
+        mantissa |= 0x800000;
+        shift = static_cast<std::uint32_t>(14 - rebased);
+        half = mantissa >> shift;
+    } else {
+        half = (static_cast<std::uint32_t>(rebased) << 10) | (mantissa >> shift);
+    }
+
+    // a carry out of the mantissa correctly moves to the next exponent
+    std::uint32_t rest = mantissa & ((1u << shift) - 1);
+    std::uint32_t halfway = 1u << (shift - 1);
+    if (rest > halfway || (rest == halfway && (half & 1))) {
+        half++;
+    }
+    return static_cast<std::uint16_t>(sign | half);
+}
+
+[[nodiscard]] inline float halfToFloat(std::uint16_t half) {
+    std::uint32_t sign = static_cast<std::uint32_t>(half & 0x8000) << 16;
+    std::uint32_t exponent = (half >> 10) & 0x1F;
+    std::uint32_t mantissa = half & 0x3FF;
+
+    if (exponent == 0) {
+        float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 31) {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+// Projects the unit normal onto an octahedron and unfolds it into [-1, 1]^2.
+inline void octEncode(Vector3 normal, std::int16_t &x, std::int16_t &y) {
+    float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float ox = length > 0.0f ? normal.x / length : 0.0f;
+    float oy = length > 0.0f ? normal.y / length : 0.0f;
+
+    if (normal.z < 0.0f) {
+        float fx = (1.0f - std::abs(oy)) * (ox >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - std::abs(ox)) * (oy >= 0.0f ? 1.0f : -1.0f);
+        ox = fx;
+        oy = fy;
+    }
+
+    x = static_cast<std::int16_t>(std::round(std::clamp(ox, -1.0f, 1.0f) * 32767.0f));
+    y = static_cast<std::int16_t>(std::round(std::clamp(oy, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Matches octDecode in entity.vert.
+[[nodiscard]] inline Vector3 octDecode(std::int16_t x, std::int16_t y) {
+    float ex = std::max(static_cast<float>(x) / 32767.0f, -1.0f);
+    float ey = std::max(static_cast<float>(y) / 32767.0f, -1.0f);
+
+    Vector3 n{ex, ey, 1.0f - std::abs(ex) - std::abs(ey)};
+    if (n.z < 0.0f) {
+        n.x = (1.0f - std::abs(ey)) * (ex >= 0.0f ? 1.0f : -1.0f);
+        n.y = (1.0f - std::abs(ex)) * (ey >= 0.0f ? 1.0f : -1.0f);
+    }
+    return n.normalized();
+}
+
+// Packed if the vertices fit the tolerances above, full floats otherwise.
+[[nodiscard]] VertexFormat chooseVertexFormat(const Vertex *vertices, unsigned int count);
+
+// Writes `count` packed vertices to `out` and returns how to decode their positions.
+VertexQuantization packVertices(const Vertex *vertices, unsigned int count, PackedVertex *out);
+
+[[nodiscard]] Vector3 unpackPosition(const PackedVertex &vertex,
+                                     const VertexQuantization &quantization);
+
+#endif
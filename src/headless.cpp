@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <format>
+#include <string_view>
+#include <vector>
+
+#include "core/file.h"
+#include "core/jobs.h"
+#include "core/logger.h"
+#include "core/png.h"
+#include "core/random.h"
+#include "game/dungeon.h"
+#include "game/dungeon_mesh.h"
+#include "game/fov.h"
+#include "game/pathfinding.h"
+#include "game/simulation.h"
+#include "graphics/graphics.h"
+#include "graphics/mesh.h"
+#include "headless.h"
+#include "platform/platform.h"
+
+template <typename T> static bool parseNumber(const char *text, T &out) {
+    std::string_view view(text);
+    auto [end, error] = std::from_chars(view.data(), view.data() + view.size(), out);
+    return error == std::errc() && end == view.data() + view.size();
+}
+
+bool parseHeadlessArgs(int argc, char **argv, HeadlessConfig &out) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg(argv[i]);
+
+        if (arg == "--headless") {
+            out.enabled = true;
+            continue;
+        }
+        if (arg == "--render") {
+            out.render = true;
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            Log(LogLevel::ERROR, std::format("Missing value for argument {}", arg).c_str());
+            return false;
+        }
+
+        const char *value = argv[++i];
+        bool ok;
+        if (arg == "--entities") {
+            ok = parseNumber(value, out.entities);
+        } else if (arg == "--ticks") {
+            ok = parseNumber(value, out.ticks);
+        } else if (arg == "--threads") {
+            ok = parseNumber(value, out.threads);
+        } else if (arg == "--seed") {
+            ok = parseNumber(value, out.seed);
+        } else if (arg == "--profile") {
+            out.profilePath = value;
+            ok = !out.profilePath.empty();
+        } else if (arg == "--frames") {
+            ok = parseNumber(value, out.frames);
+        } else if (arg == "--width") {
+            ok = parseNumber(value, out.width) && out.width > 0;
+        } else if (arg == "--height") {
+            ok = parseNumber(value, out.height) && out.height > 0;
+        } else if (arg == "--png") {
+            out.pngPath = value;
+            ok = !out.pngPath.empty();
+        } else {
+            Log(LogLevel::ERROR, std::format("Unknown argument {}", arg).c_str());
+            return false;
+        }
+
+        if (!ok) {
+            Log(LogLevel::ERROR, std::format("Invalid value {} for {}", value, arg).c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void spawnBenchmarkEntities(Simulation &sim, std::uint32_t count, std::uint64_t seed) {
+    Random rng = makeRandom(seed);
+    float extent = static_cast<float>(count) / 100.0f + 16.0f;
+
+    EntityManager &manager = sim.entities;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        EntityId id = makeEntity(manager, i == 0 ? EntityType::Player : EntityType::Enemy);
+        std::uint32_t dense = getEntityIndex(manager, id);
+
+        manager.positions[dense] =
+            Vector3{randomRange(rng, -extent, extent), 0, randomRange(rng, -extent, extent)};
+        manager.velocities[dense] =
+            Vector3{randomRange(rng, -1.0f, 1.0f), 0, randomRange(rng, -1.0f, 1.0f)};
+    }
+}
+
+// `sorted` in seconds, the result in milliseconds.
+static double percentileMs(const std::vector<double> &sorted, std::size_t p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    return sorted[std::min(sorted.size() - 1, sorted.size() * p / 100)] * 1000.0;
+}
+
+int runHeadless(const HeadlessConfig &config) {
+    Platform platform;
+    if (!platformInitHeadless(&platform)) {
+        return -1;
+    }
+
+    JobSystem jobs;
+    initJobSystem(jobs, config.threads);
+
+    Simulation sim;
+    initSimulation(sim);
+    spawnBenchmarkEntities(sim, config.entities, config.seed);
+    spatialSync(sim.spatial, sim.entities);
+
+    const float deltaTime = 1.0f / 60.0f;
+
+    std::vector<double> tickTimes;
+    tickTimes.reserve(config.ticks);
+
+    double start = platform.api.getTimeSeconds(&platform);
+    for (std::uint32_t i = 0; i < config.ticks; ++i) {
+        double tickStart = platform.api.getTimeSeconds(&platform);
+        updateSimulation(sim, jobs, deltaTime);
+        tickTimes.push_back(platform.api.getTimeSeconds(&platform) - tickStart);
+    }
+    double elapsed = platform.api.getTimeSeconds(&platform) - start;
+
+    std::uint64_t checksum = checksumSimulation(sim);
+
+    std::sort(tickTimes.begin(), tickTimes.end());
+
+    Log(LogLevel::INFO,
+        std::format("[Headless] {} entities, {} ticks on {} worker(s)", config.entities,
+                    config.ticks, jobs.workerCount())
+            .c_str());
+    Log(LogLevel::INFO,
+        std::format("[Headless] {:.1f} ticks/sec, p50 {:.3f} ms, p99 {:.3f} ms",
+                    elapsed > 0.0 ? config.ticks / elapsed : 0.0, percentileMs(tickTimes, 50),
+                    percentileMs(tickTimes, 99))
+            .c_str());
+    Log(LogLevel::INFO, std::format("[Headless] checksum {:016x}", checksum).c_str());
+
+    shutdownSimulation(sim);
+    shutdownJobSystem(jobs);
+    platformShutdown(&platform);
+
+    return 0;
+}
+
+int runRenderBenchmark(const HeadlessConfig &config) {
+    Platform platform;
+    if (!platformInitOffscreen(&platform)) {
+        return -1;
+    }
+    if (!platform.api.windowCreate(&platform, {"Roguelike", config.width, config.height})) {
+        platformShutdown(&platform);
+        return -1;
+    }
+    PlatformWindow *window = platform.window;
+
+    unsigned int shaderProgram = initGraphics();
+
+    MeshRegistry registry;
+    std::string contents;
+    if (!readTextFile("../resources/cube.obj", contents)) {
+        Log(LogLevel::FATAL, "File could not be opened");
+        shutdownGraphics(shaderProgram);
+        platform.api.windowDestroy(&platform);
+        platformShutdown(&platform);
+        return -1;
+    }
+    MeshId actorMesh = makeMeshFromObj(registry, contents);
+
+    JobSystem jobs;
+    initJobSystem(jobs, config.threads);
+
+    Simulation sim;
+    initSimulation(sim);
+    EntityManager &manager = sim.entities;
+
+    DungeonConfig dungeonConfig;
+    dungeonConfig.seed = config.seed;
+    Dungeon dungeon;
+    generateDungeon(dungeon, dungeonConfig, jobs);
+    EntityId player = spawnDungeon(dungeon, manager, actorMesh);
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, dungeonConfig.chunkSize);
+    meshDungeon(mesher, dungeon, manager, registry, jobs);
+    spatialSync(sim.spatial, manager);
+
+    FlowField flowField;
+    initFlowField(flowField, dungeon);
+    EntityQuery *chasers = registerQuery(
+        manager, componentBit(COMPONENT_VELOCITY) | componentBit(COMPONENT_ENEMY));
+    EntityQuery *drawable =
+        registerQuery(manager, componentBit(COMPONENT_TRANSFORM) | componentBit(COMPONENT_MESH));
+
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 12);
+
+    const float deltaTime = 1.0f / 60.0f;
+
+    RenderSnapshot snapshot;
+    std::vector<Vector3> previousPositions;
+    EntityRenderer renderer;
+
+    std::vector<double> frameTimes;
+    frameTimes.reserve(config.frames);
+
+    for (std::uint32_t frame = 0; frame < config.frames; ++frame) {
+        // the script: the player walks in a slow circle and the enemies chase it, one tick per
+        // frame, so every run with the same seed sees the same frames
+        float t = (float)frame * deltaTime;
+        manager.velocities[getEntityIndex(manager, player)] =
+            Vector3{std::cos(t * 0.5f), 0, std::sin(t * 0.5f)} * 2.0f;
+
+        std::uint32_t playerX, playerY;
+        if (flowFieldTile(flowField, manager.positions[getEntityIndex(manager, player)], playerX,
+                          playerY)) {
+            updateFlowField(flowField, dungeon, playerX, playerY, jobs);
+        }
+        steerAlongFlowField(flowField, manager, *chasers, 2.0f, jobs);
+        updateSimulation(sim, jobs, deltaTime);
+
+        if (flowFieldTile(flowField, manager.positions[getEntityIndex(manager, player)], playerX,
+                          playerY)) {
+            updateFieldOfView(fov, dungeon, playerX, playerY);
+        }
+
+        captureRenderSnapshot(snapshot, manager, *drawable);
+        snapshot.tick = sim.tick;
+        snapshot.width = window->width;
+        snapshot.height = window->height;
+        snapshot.visible = fov.visible;
+        previousPositions = snapshot.positions;
+
+        // only the render side is timed, the swap waits for the GPU to finish the frame
+        double frameStart = platform.api.getTimeSeconds(&platform);
+        drawEntities(snapshot, previousPositions, 1.0f, shaderProgram, registry, renderer);
+        platform.api.swapBuffers(&platform);
+        frameTimes.push_back(platform.api.getTimeSeconds(&platform) - frameStart);
+    }
+
+    double total = 0.0;
+    for (double time : frameTimes) {
+        total += time;
+    }
+    std::sort(frameTimes.begin(), frameTimes.end());
+
+    const RenderStats &stats = renderer.stats;
+    double frames = std::max<double>(1.0, (double)stats.frames);
+    Log(LogLevel::INFO,
+        std::format("[Render] {} frames at {}x{}, {} entities", config.frames, window->width,
+                    window->height, manager.count())
+            .c_str());
+    Log(LogLevel::INFO,
+        std::format("[Render] {:.1f} frames/sec, mean {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms",
+                    total > 0.0 ? config.frames / total : 0.0,
+                    frameTimes.empty() ? 0.0 : total * 1000.0 / (double)frameTimes.size(),
+                    percentileMs(frameTimes, 50), percentileMs(frameTimes, 99))
+            .c_str());
+    Log(LogLevel::INFO,
+        std::format("[Render] {:.1f} draws, {:.1f} packets, {:.1f} culled per frame",
+                    (double)stats.draws / frames, (double)stats.packets / frames,
+                    (double)stats.culled / frames)
+            .c_str());
+
+    int result = 0;
+    if (!config.pngPath.empty()) {
+        std::vector<std::uint8_t> rgba;
+        readFramebuffer(window->width, window->height, rgba);
+        if (writePng(config.pngPath.c_str(), (std::uint32_t)window->width,
+                     (std::uint32_t)window->height, rgba.data())) {
+            Log(LogLevel::INFO, std::format("[Render] Wrote last frame to {} (crc32 {:08x})",
+                                            config.pngPath, crc32(rgba.data(), rgba.size()))
+                                    .c_str());
+        } else {
+            result = -1;
+        }
+    }
+
+    destroyMeshArenas(registry);
+    registry.clear();
+    shutdownSimulation(sim);
+    shutdownJobSystem(jobs);
+    shutdownGraphics(shaderProgram);
+
+    platform.api.windowDestroy(&platform);
+    platformShutdown(&platform);
+
+    return result;
+}
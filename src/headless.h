@@ -0,0 +1,43 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <cstdint>
+#include <string>
+
+// `Game --headless [--entities N] [--ticks M] [--threads T] [--seed S]`
+// Spawns N entities from the seed, runs M fixed ticks back to back without a window or GL and
+// reports throughput, per-tick latency and a checksum of the final world. The checksum only
+// depends on the seed and the counts, never on the thread count.
+//
+// `Game --render [--frames F] [--width W] [--height H] [--png PATH] [--seed S] [--threads T]`
+// Generates the dungeon for the seed and draws F frames of a scripted walk through it into an
+// offscreen framebuffer (surfaceless EGL, llvmpipe works), reporting per-frame render times.
+// With --png the last frame is read back and written out for golden image comparisons, the
+// capture only depends on the seed, the frame count, the size and the driver.
+//
+// The same arguments are parsed for the windowed game, which also takes `--profile PREFIX` to write
+// per-frame CPU and GPU timings to PREFIX_main.csv and PREFIX_render.csv.
+struct HeadlessConfig {
+    bool enabled = false;
+    std::uint32_t entities = 10000;
+    std::uint32_t ticks = 1000;
+    std::uint32_t threads = 0;
+    std::uint64_t seed = 1;
+
+    // empty when profiling output is off
+    std::string profilePath;
+
+    bool render = false;
+    std::uint32_t frames = 600;
+    int width = 1280;
+    int height = 720;
+    // empty when the last frame is not captured
+    std::string pngPath;
+};
+
+// Returns false if the arguments could not be parsed.
+bool parseHeadlessArgs(int argc, char **argv, HeadlessConfig &out);
+int runHeadless(const HeadlessConfig &config);
+int runRenderBenchmark(const HeadlessConfig &config);
+
+#endif
@@ -1,16 +1,43 @@
+#include <chrono>
 #include <format>
-#include <fstream>
 
 #include "core/assert.h"
+#include "core/file.h"
+#include "core/jobs.h"
 #include "core/logger.h"
 #include "core/math.h"
+#include "core/profiler.h"
+#include "game/dungeon.h"
+#include "game/dungeon_mesh.h"
 #include "game/entity.h"
+#include "game/fov.h"
+#include "game/pathfinding.h"
+#include "game/save.h"
+#include "game/simulation.h"
+#include "game/transform.h"
 #include "graphics/graphics.h"
 #include "graphics/mesh.h"
+#include "graphics/renderer.h"
+#include "headless.h"
 #include "platform/input.h"
 #include "platform/platform.h"
 
-int main(void) {
+// once a minute at 60 ticks a second
+constexpr std::uint64_t AUTOSAVE_TICKS = 60 * 60;
+constexpr const char *AUTOSAVE_PATH = "autosave.rlsv";
+
+int main(int argc, char **argv) {
+    HeadlessConfig headless;
+    if (!parseHeadlessArgs(argc, argv, headless)) {
+        return -1;
+    }
+    if (headless.render) {
+        return runRenderBenchmark(headless);
+    }
+    if (headless.enabled) {
+        return runHeadless(headless);
+    }
+
     Platform platform;
     if (!platformInit(&platform)) {
         return -1;
@@ -26,33 +53,48 @@ int main(void) {
 
     MeshRegistry registry;
 
-    std::ifstream file("../resources/cube.obj");
-    if (!file.is_open()) {
+    std::string contents;
+    if (!readTextFile("../resources/cube.obj", contents)) {
         Log(LogLevel::FATAL, "File could not be opened");
         return -1;
     }
 
-    std::string contents;
-    std::string line;
-    while (getline(file, line)) {
-        contents += line + '\n';
-    }
+    MeshId mId = makeMeshFromObj(registry, contents);
 
-    file.close();
+    JobSystem jobs;
+    initJobSystem(jobs);
 
-    MeshId mId = registry.add(makeMeshFromObj(contents));
+    Simulation sim;
+    initSimulation(sim);
+    EntityManager &manager = sim.entities;
 
-    EntityManager manager;
+    DungeonConfig dungeonConfig;
+    dungeonConfig.seed = (std::uint64_t)std::chrono::system_clock::now().time_since_epoch().count();
+    Log(LogLevel::INFO, std::format("[Dungeon] Seed {}", dungeonConfig.seed).c_str());
 
-    Entity *player = makeEntity(manager, EntityType::Player);
-    player->position = Vector3{0, 0, 0};
-    player->scale = Vector3{1, 1, 1};
-    player->mesh = mId;
+    Dungeon dungeon;
+    generateDungeon(dungeon, dungeonConfig, jobs);
 
-    Entity *enemy = makeEntity(manager, EntityType::Enemy);
-    enemy->position = Vector3{5, 0, -5};
-    enemy->scale = Vector3{1, 1, 1};
-    enemy->mesh = mId;
+    EntityId player = spawnDungeon(dungeon, manager, mId);
+    ASSERT(player != ENTITY_INVALID_ID);
+
+    // the chunk meshes are uploaded here, before the context moves to the render thread, later
+    // rebuilds go through the render thread's upload queue
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, dungeonConfig.chunkSize);
+    meshDungeon(mesher, dungeon, manager, registry, jobs);
+    // spawned directly, not through the command buffer
+    spatialSync(sim.spatial, manager);
+    // the first snapshot can come before the first tick
+    updateTransforms(manager, jobs);
+
+    FlowField flowField;
+    initFlowField(flowField, dungeon);
+    EntityQuery *chasers = registerQuery(
+        manager, componentBit(COMPONENT_VELOCITY) | componentBit(COMPONENT_ENEMY));
+
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 12);
 
     double time = 0.0;
     double deltaTime = 1.0 / 60.0; // 60HZ
@@ -60,7 +102,31 @@ int main(void) {
     double currentTime = platform.api.getTimeSeconds(&platform);
     double accumulator = 0.0;
 
+    // meshes and shaders are loaded, hand the context over to the render thread
+    platform.api.makeContextCurrent(&platform, false);
+
+    EntityQuery *drawable =
+        registerQuery(manager, componentBit(COMPONENT_TRANSFORM) | componentBit(COMPONENT_MESH));
+
+    Profiler profiler;
+    std::uint32_t inputScope = addProfileScope(profiler, "input");
+    std::uint32_t updateScope = addProfileScope(profiler, "update");
+    std::uint32_t snapshotScope = addProfileScope(profiler, "snapshot");
+    std::uint32_t eventsScope = addProfileScope(profiler, "events");
+
+    RenderThread renderer;
+    if (!headless.profilePath.empty()) {
+        openProfileCsv(profiler, (headless.profilePath + "_main.csv").c_str());
+        renderer.profilePath = headless.profilePath + "_render.csv";
+    }
+    startRenderThread(renderer, &platform, registry, shaderProgram);
+
+    SaveWriter autosave;
+    std::uint64_t nextAutosave = AUTOSAVE_TICKS;
+
     while (!window->shouldClose) {
+        beginProfileFrame(profiler);
+
         double newTime = platform.api.getTimeSeconds(&platform);
         double frameTime = newTime - currentTime;
         currentTime = newTime;
@@ -71,39 +137,105 @@ int main(void) {
 
         accumulator += frameTime;
 
+        beginProfileScope(profiler, inputScope);
         float leftX = platform.api.getAxisValue(&platform, JoystickAxis::LEFT_X);
         float leftY = platform.api.getAxisValue(&platform, JoystickAxis::LEFT_Y);
 
+        Vector3 playerVelocity = Vector3{0, 0, 0};
+
         if (platform.api.isKeyPressed(&platform, 87) || leftY <= -0.1) {
-            player->position.z -= deltaTime * 1.0f;
+            playerVelocity.z -= 1.0f;
         }
         if (platform.api.isKeyPressed(&platform, 83) || leftY >= 0.1) {
-            player->position.z += deltaTime * 1.0f;
+            playerVelocity.z += 1.0f;
         }
         if (platform.api.isKeyPressed(&platform, 68) || leftX >= 0.1) {
-            player->position.x += deltaTime * 1.0f;
+            playerVelocity.x += 1.0f;
         }
         if (platform.api.isKeyPressed(&platform, 65) || leftX <= -0.1) {
-            player->position.x -= deltaTime * 1.0f;
+            playerVelocity.x -= 1.0f;
         }
 
+        manager.velocities[getEntityIndex(manager, player)] = playerVelocity;
+        endProfileScope(profiler, inputScope);
+
+        bool ticked = false;
         while (accumulator >= deltaTime) {
-            // update()
+            beginProfileScope(profiler, updateScope);
+
+            // the field is only rebuilt when the player crosses into another tile
+            std::uint32_t playerX, playerY;
+            if (flowFieldTile(flowField, manager.positions[getEntityIndex(manager, player)],
+                              playerX, playerY)) {
+                updateFlowField(flowField, dungeon, playerX, playerY, jobs);
+            }
+            steerAlongFlowField(flowField, manager, *chasers, 2.0f, jobs);
+
+            updateSimulation(sim, jobs, (float)deltaTime);
+
             time += deltaTime;
             accumulator -= deltaTime;
-        }
+            ticked = true;
 
-        const double alpha = accumulator / deltaTime;
-
-        // render(window, alpha)
+            endProfileScope(profiler, updateScope);
+        }
 
-        drawEntities(manager.entities, shaderProgram, registry, window->width, window->height);
+        // between ticks nothing writes the columns, the frame only pays for copying them out and
+        // the disk is left to the writer thread
+        if (sim.tick >= nextAutosave && startSaveWorld(autosave, AUTOSAVE_PATH, sim)) {
+            nextAutosave = sim.tick + AUTOSAVE_TICKS;
+        }
+        pollSaveWorld(autosave);
+
+        // chunks edited through editDungeonTile are rebuilt by the workers and uploaded on a later
+        // frame
+        remeshDirtyChunks(mesher, dungeon, jobs, renderer.uploads);
+
+        if (ticked || sim.tick == 0) {
+            beginProfileScope(profiler, snapshotScope);
+
+            // only recasts when the player reached another tile
+            std::uint32_t viewerX, viewerY;
+            if (flowFieldTile(flowField, manager.positions[getEntityIndex(manager, player)],
+                              viewerX, viewerY)) {
+                updateFieldOfView(fov, dungeon, viewerX, viewerY);
+            }
+
+            RenderSnapshot &snapshot = renderer.snapshots.writeBuffer();
+            captureRenderSnapshot(snapshot, manager, *drawable);
+            snapshot.tick = sim.tick;
+            snapshot.publishTime = platform.api.getTimeSeconds(&platform);
+            snapshot.alpha = accumulator / deltaTime;
+            snapshot.tickDelta = deltaTime;
+            snapshot.width = window->width;
+            snapshot.height = window->height;
+            snapshot.visible = fov.visible;
+            renderer.snapshots.publish();
+
+            endProfileScope(profiler, snapshotScope);
+        }
 
+        beginProfileScope(profiler, eventsScope);
         platform.api.pumpEvents(&platform);
+        endProfileScope(profiler, eventsScope);
+
+        if (!ticked) {
+            platform.api.sleepMs(&platform, 1);
+        }
     }
 
+    waitForCounter(jobs, mesher.building);
+    finishSaveWorld(autosave);
+    stopRenderThread(renderer);
+    platform.api.makeContextCurrent(&platform, true);
+
+    closeProfiler(profiler);
+    logProfileStats(profiler, "main");
+
+    destroyMeshArenas(registry);
     registry.clear();
-    destroyAllEntities(manager);
+    shutdownSimulation(sim);
+    shutdownJobSystem(jobs);
 
     shutdownGraphics(shaderProgram);
 }
@@ -7,6 +7,10 @@ bool platformCreate_mac(Platform *out);
 #elif defined(PLATFORM_LINUX)
 bool platformCreate_linux(Platform *out);
 #endif
+#ifdef PLATFORM_EGL
+bool platformCreate_egl(Platform *out);
+#endif
+bool platformCreate_headless(Platform *out);
 
 bool platformInit(Platform *out) {
 #ifdef PLATFORM_WINDOWS
@@ -25,6 +29,29 @@ bool platformInit(Platform *out) {
     return false;
 }
 
+bool platformInitHeadless(Platform *out) {
+    platformCreate_headless(out);
+    if (out->api.init) {
+        out->api.init(out);
+        return true;
+    }
+    return false;
+}
+
+bool platformInitOffscreen(Platform *out) {
+#ifdef PLATFORM_EGL
+    platformCreate_egl(out);
+#else
+    Log(LogLevel::ERROR, "Offscreen rendering needs EGL, this build was made without it");
+    return false;
+#endif
+    if (out->api.init) {
+        out->api.init(out);
+        return true;
+    }
+    return false;
+}
+
 void platformShutdown(Platform *p) {
     if (!p) {
         return;
@@ -36,6 +36,11 @@ struct PlatformAPI {
     bool (*windowCreate)(Platform *p, const PlatformWindowConfig &config);
     void (*windowDestroy)(Platform *p);
 
+    // The GL context is current on one thread at a time, release it before another thread
+    // makes it current.
+    void (*makeContextCurrent)(Platform *p, bool current);
+    void (*swapBuffers)(Platform *p);
+
     bool (*isKeyPressed)(Platform *p, int keyCode);
     float (*getAxisValue)(Platform *p, JoystickAxis axis);
 
@@ -51,6 +56,11 @@ struct Platform {
 };
 
 bool platformInit(Platform *out);
+// Windowless backend available on every OS, for benchmarks and build servers.
+bool platformInitHeadless(Platform *out);
+// GL without a window, rendering into an offscreen framebuffer of the window's size. Needs a
+// Linux build that found EGL (PLATFORM_EGL), returns false elsewhere.
+bool platformInitOffscreen(Platform *out);
 void platformShutdown(Platform *p);
 
 #endif
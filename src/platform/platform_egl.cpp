@@ -0,0 +1,272 @@
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "../graphics/opengl.h"
+
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <thread>
+
+#include "../core/logger.h"
+#include "input.h"
+#include "platform.h"
+
+// Offscreen backend: a GL 3.3 core context on a surfaceless EGL display, drawing into a
+// framebuffer object the size of the requested window. Runs anywhere Mesa does, including
+// llvmpipe on machines without a GPU or display, for render benchmarks and golden images. Input
+// always reads as idle.
+
+struct EglState {
+    std::chrono::steady_clock::time_point start;
+
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+
+    GLuint framebuffer = 0;
+    GLuint color = 0;
+    GLuint depth = 0;
+};
+
+static bool hasEglExtension(const char *extensions, const char *name) {
+    if (extensions == nullptr) {
+        return false;
+    }
+    std::size_t length = std::strlen(name);
+    for (const char *p = std::strstr(extensions, name); p; p = std::strstr(p + length, name)) {
+        bool start = p == extensions || p[-1] == ' ';
+        bool end = p[length] == ' ' || p[length] == '\0';
+        if (start && end) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The surfaceless platform needs neither X11 nor Wayland, the default display is the fallback
+// for older drivers.
+static EGLDisplay openDisplay() {
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasEglExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            return getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                      nullptr);
+        }
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static bool createContext(EglState *state) {
+    state->display = openDisplay();
+    EGLint major, minor;
+    if (state->display == EGL_NO_DISPLAY || !eglInitialize(state->display, &major, &minor)) {
+        Log(LogLevel::FATAL, "[EGL] Could not open a display");
+        return false;
+    }
+    Log(LogLevel::DEBUG, std::format("[EGL] Initialized EGL {}.{}", major, minor).c_str());
+
+    if (!hasEglExtension(eglQueryString(state->display, EGL_EXTENSIONS),
+                         "EGL_KHR_surfaceless_context")) {
+        Log(LogLevel::FATAL, "[EGL] Display does not support surfaceless contexts");
+        return false;
+    }
+
+    // nothing is ever drawn to an EGL surface, the config only has to allow desktop GL
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE,
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(state->display, configAttributes, &config, 1, &configCount) ||
+        configCount == 0) {
+        Log(LogLevel::FATAL, "[EGL] No config supports desktop OpenGL");
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        Log(LogLevel::FATAL, "[EGL] Could not bind the OpenGL API");
+        return false;
+    }
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION,
+        3,
+        EGL_CONTEXT_MINOR_VERSION,
+        3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK,
+        EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+    state->context = eglCreateContext(state->display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (state->context == EGL_NO_CONTEXT) {
+        Log(LogLevel::FATAL,
+            std::format("[EGL] Context creation failed ({:#x})", eglGetError()).c_str());
+        return false;
+    }
+
+    return eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, state->context);
+}
+
+// Undoes as much of createContext as got done.
+static void destroyContext(EglState *state) {
+    if (state->display == EGL_NO_DISPLAY) {
+        return;
+    }
+
+    eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (state->context != EGL_NO_CONTEXT) {
+        eglDestroyContext(state->display, state->context);
+        state->context = EGL_NO_CONTEXT;
+    }
+    eglTerminate(state->display);
+    state->display = EGL_NO_DISPLAY;
+}
+
+// Stays bound for the lifetime of the context, the renderer never binds framebuffer 0.
+static bool createFramebuffer(EglState *state, int width, int height) {
+    glGenRenderbuffers(1, &state->color);
+    glBindRenderbuffer(GL_RENDERBUFFER, state->color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &state->depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, state->depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &state->framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, state->framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              state->color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              state->depth);
+
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// Needs the context current, names that were never generated are 0 and skipped by GL.
+static void destroyFramebuffer(EglState *state) {
+    glDeleteFramebuffers(1, &state->framebuffer);
+    glDeleteRenderbuffers(1, &state->color);
+    glDeleteRenderbuffers(1, &state->depth);
+    state->framebuffer = 0;
+    state->color = 0;
+    state->depth = 0;
+}
+
+bool egl_init(Platform *p) {
+    p->state = new EglState{std::chrono::steady_clock::now()};
+    return true;
+}
+
+void egl_shutdown(Platform *p) {
+    if (p->state == nullptr) {
+        return;
+    }
+    delete (EglState *)p->state;
+    p->state = nullptr;
+}
+
+double egl_getTimeSeconds(Platform *p) {
+    EglState *state = (EglState *)p->state;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - state->start;
+    return elapsed.count();
+}
+
+void egl_sleepMs(Platform *p, int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+bool egl_windowCreate(Platform *p, const PlatformWindowConfig &config) {
+    EglState *state = (EglState *)p->state;
+    if (!createContext(state)) {
+        destroyContext(state);
+        return false;
+    }
+
+    glbinding::initialize(eglGetProcAddress);
+
+    Log(LogLevel::INFO,
+        std::format("[EGL] Rendering offscreen on {}",
+                    reinterpret_cast<const char *>(glGetString(GL_RENDERER)))
+            .c_str());
+
+    int width = config.width > 0 ? config.width : 1280;
+    int height = config.height > 0 ? config.height : 720;
+    if (!createFramebuffer(state, width, height)) {
+        Log(LogLevel::FATAL, "[EGL] Offscreen framebuffer is incomplete");
+        destroyFramebuffer(state);
+        destroyContext(state);
+        return false;
+    }
+
+    PlatformWindow *_w = new PlatformWindow{};
+    _w->handle = state->context;
+    _w->width = width;
+    _w->height = height;
+    p->window = _w;
+
+    return true;
+}
+
+void egl_windowDestroy(Platform *p) {
+    if (p->window == nullptr) {
+        return;
+    }
+
+    EglState *state = (EglState *)p->state;
+    eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE, state->context);
+    destroyFramebuffer(state);
+    destroyContext(state);
+
+    delete p->window;
+    p->window = nullptr;
+}
+
+void egl_makeContextCurrent(Platform *p, bool current) {
+    if (p->window == nullptr) {
+        return;
+    }
+
+    EglState *state = (EglState *)p->state;
+    eglMakeCurrent(state->display, EGL_NO_SURFACE, EGL_NO_SURFACE,
+                   current ? state->context : EGL_NO_CONTEXT);
+}
+
+// Nothing to present. Waits for the frame instead, so frame times include the GPU work and frames
+// can't queue up behind each other.
+void egl_swapBuffers(Platform *p) {
+    if (p->window == nullptr) {
+        return;
+    }
+
+    glFinish();
+}
+
+bool egl_isKeyPressed(Platform *p, int keyCode) {
+    return false;
+}
+
+float egl_getAxisValue(Platform *p, JoystickAxis axis) {
+    return 0.0F;
+}
+
+void egl_pumpEvents(Platform *p) {}
+
+bool platformCreate_egl(Platform *out) {
+    out->api = {};
+
+    out->api.init = egl_init;
+    out->api.shutdown = egl_shutdown;
+    out->api.getTimeSeconds = egl_getTimeSeconds;
+    out->api.sleepMs = egl_sleepMs;
+    out->api.windowCreate = egl_windowCreate;
+    out->api.windowDestroy = egl_windowDestroy;
+    out->api.makeContextCurrent = egl_makeContextCurrent;
+    out->api.swapBuffers = egl_swapBuffers;
+    out->api.isKeyPressed = egl_isKeyPressed;
+    out->api.getAxisValue = egl_getAxisValue;
+    out->api.pumpEvents = egl_pumpEvents;
+
+    return true;
+}
@@ -0,0 +1,75 @@
+#include <chrono>
+#include <thread>
+
+#include "../core/logger.h"
+#include "input.h"
+#include "platform.h"
+
+// Backend without a window or GL context, used to run the simulation on machines without a
+// display. Input always reads as idle.
+
+struct HeadlessState {
+    std::chrono::steady_clock::time_point start;
+};
+
+bool headless_init(Platform *p) {
+    p->state = new HeadlessState{std::chrono::steady_clock::now()};
+    return true;
+}
+
+void headless_shutdown(Platform *p) {
+    if (p->state == nullptr) {
+        return;
+    }
+    delete (HeadlessState *)p->state;
+    p->state = nullptr;
+}
+
+double headless_getTimeSeconds(Platform *p) {
+    HeadlessState *state = (HeadlessState *)p->state;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - state->start;
+    return elapsed.count();
+}
+
+void headless_sleepMs(Platform *p, int ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+bool headless_windowCreate(Platform *p, const PlatformWindowConfig &config) {
+    Log(LogLevel::ERROR, "[Headless] Cannot create a window on the headless platform");
+    return false;
+}
+
+void headless_windowDestroy(Platform *p) {}
+
+void headless_makeContextCurrent(Platform *p, bool current) {}
+
+void headless_swapBuffers(Platform *p) {}
+
+bool headless_isKeyPressed(Platform *p, int keyCode) {
+    return false;
+}
+
+float headless_getAxisValue(Platform *p, JoystickAxis axis) {
+    return 0.0F;
+}
+
+void headless_pumpEvents(Platform *p) {}
+
+bool platformCreate_headless(Platform *out) {
+    out->api = {};
+
+    out->api.init = headless_init;
+    out->api.shutdown = headless_shutdown;
+    out->api.getTimeSeconds = headless_getTimeSeconds;
+    out->api.sleepMs = headless_sleepMs;
+    out->api.windowCreate = headless_windowCreate;
+    out->api.windowDestroy = headless_windowDestroy;
+    out->api.makeContextCurrent = headless_makeContextCurrent;
+    out->api.swapBuffers = headless_swapBuffers;
+    out->api.isKeyPressed = headless_isKeyPressed;
+    out->api.getAxisValue = headless_getAxisValue;
+    out->api.pumpEvents = headless_pumpEvents;
+
+    return true;
+}
@@ -124,6 +124,28 @@ void linux_windowDestroy(Platform *p) {
     glfwTerminate();
 };
 
+void linux_makeContextCurrent(Platform *p, bool current) {
+    if (p->window == nullptr) {
+        return;
+    }
+
+    PlatformWindow *pw = (PlatformWindow *)p->window;
+    GLFWwindow *window = (GLFWwindow *)pw->handle;
+
+    glfwMakeContextCurrent(current ? window : NULL);
+}
+
+void linux_swapBuffers(Platform *p) {
+    if (p->window == nullptr) {
+        return;
+    }
+
+    PlatformWindow *pw = (PlatformWindow *)p->window;
+    GLFWwindow *window = (GLFWwindow *)pw->handle;
+
+    glfwSwapBuffers(window);
+}
+
 bool linux_isKeyPressed(Platform *p, int keyCode) {
     if (p->window == nullptr) {
         return false;
@@ -169,9 +191,7 @@ void linux_pumpEvents(Platform *p) {
     PlatformWindow *pw = (PlatformWindow *)p->window;
     GLFWwindow *window = (GLFWwindow *)pw->handle;
 
-    // should be in renderer? or in a end-frame call maybe
-    glfwSwapBuffers(window);
-
+    // must run on the main thread, swapping is done by whichever thread owns the context
     glfwPollEvents();
 
     if (glfwWindowShouldClose(window) == 1) {
@@ -188,6 +208,8 @@ bool platformCreate_linux(Platform *out) {
     out->api.sleepMs = linux_sleepMs;
     out->api.windowCreate = linux_windowCreate;
     out->api.windowDestroy = linux_windowDestroy;
+    out->api.makeContextCurrent = linux_makeContextCurrent;
+    out->api.swapBuffers = linux_swapBuffers;
     out->api.isKeyPressed = linux_isKeyPressed;
     out->api.getAxisValue = linux_getAxisValue;
     out->api.pumpEvents = linux_pumpEvents;
@@ -0,0 +1,25 @@
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/culling.h"
+#include "../common/culling.h"
+
+TEST_CASE("Frustum culling") {
+    Frustum frustum = makeCameraFrustum();
+    CullSpheres spheres;
+    scatter(spheres, 100000, 256.0f);
+    std::vector<std::uint32_t> visible;
+    visible.reserve(spheres.count());
+
+    BENCHMARK("simd 100k") {
+        cullSpheres(frustum, spheres, visible);
+        return visible.size();
+    };
+
+    BENCHMARK("scalar 100k") {
+        cullSpheresScalar(frustum, spheres, visible);
+        return visible.size();
+    };
+}
@@ -0,0 +1,38 @@
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/dungeon.h"
+#include "../../src/game/dungeon_mesh.h"
+
+TEST_CASE("Dungeon generation") {
+    JobSystem jobs;
+    initJobSystem(jobs);
+
+    DungeonConfig config; // 512x512
+    Dungeon dungeon;
+
+    BENCHMARK("generate 512x512") {
+        generateDungeon(dungeon, config, jobs);
+        return dungeon.tiles.size();
+    };
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, config.chunkSize);
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    DungeonChunkTiles tiles;
+    BENCHMARK("chunk geometry 512x512") {
+        std::size_t triangles = 0;
+        for (std::uint32_t chunk = 0; chunk < mesher.chunks.size(); ++chunk) {
+            copyDungeonChunk(dungeon, mesher, chunk, tiles);
+            buildDungeonChunkGeometry(tiles, vertices, indices);
+            triangles += indices.size() / 3;
+        }
+        return triangles;
+    };
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,43 @@
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/random.h"
+#include "../../src/game/pathfinding.h"
+#include "../common/dungeon.h"
+
+TEST_CASE("Flow field") {
+    JobSystem jobs;
+    initJobSystem(jobs);
+    Dungeon dungeon = makeTestDungeon(jobs, 512);
+    const DungeonSpawn &player = dungeon.spawns[0];
+
+    FlowField field;
+    initFlowField(field, dungeon);
+
+    BENCHMARK("rebuild 512x512") {
+        field.dirty = true;
+        return updateFlowField(field, dungeon, player.x, player.y, jobs);
+    };
+
+    // a crowd spread over the floor, all chasing the player
+    EntityManager manager;
+    Random rng = makeRandom(5);
+    while (manager.count() < 10000) {
+        std::uint32_t x = (std::uint32_t)randomInt(rng, 0, (std::int32_t)dungeon.width - 1);
+        std::uint32_t y = (std::uint32_t)randomInt(rng, 0, (std::int32_t)dungeon.height - 1);
+        if (dungeon.at(x, y) == TILE_FLOOR) {
+            EntityId id = makeEntity(manager, EntityType::Enemy);
+            manager.positions[getEntityIndex(manager, id)] = Vector3{(float)x, 0, (float)y};
+        }
+    }
+    EntityQuery *chasers = registerQuery(manager, componentBit(COMPONENT_ENEMY));
+
+    BENCHMARK("steer 10k chasers") {
+        steerAlongFlowField(field, manager, *chasers, 4.0f, jobs);
+        return manager.velocities[0].x;
+    };
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,37 @@
+#include <cstdio>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/save.h"
+#include "../../src/game/simulation.h"
+#include "../common/world.h"
+
+TEST_CASE("Save and load cost at 100k entities") {
+    Simulation sim;
+    initSimulation(sim);
+    populateWorld(sim, 100000);
+
+    std::string path = tempPath("roguelike_bench.sav");
+
+    BENCHMARK("save 100k entities") {
+        return saveWorld(path.c_str(), sim);
+    };
+
+    Simulation target;
+    initSimulation(target);
+
+    BENCHMARK("open and validate 100k entities") {
+        SaveView view;
+        bool ok = openSave(path.c_str(), view);
+        closeSave(view);
+        return ok;
+    };
+
+    BENCHMARK("load 100k entities") {
+        return loadWorld(path.c_str(), target);
+    };
+
+    std::remove(path.c_str());
+}
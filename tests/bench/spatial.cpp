@@ -0,0 +1,42 @@
+#include <cmath>
+#include <string>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/entity.h"
+#include "../../src/game/spatial.h"
+#include "../common/spatial.h"
+
+TEST_CASE("Spatial hash query cost at scale") {
+    for (std::uint32_t count : {1000u, 10000u, 100000u}) {
+        EntityManager manager;
+        // constant density, the map grows with the entity count
+        populateScattered(manager, count, std::sqrt(static_cast<float>(count)) * 2.0f);
+
+        SpatialHash hash;
+        initSpatialHash(hash, 4.0f);
+        spatialSync(hash, manager);
+
+        std::vector<EntityId> out;
+        Vector3 center = Vector3{0, 0, 0};
+
+        BENCHMARK("radius 10, spatial hash, n=" + std::to_string(count)) {
+            out.clear();
+            spatialQueryRadius(hash, center, 10.0f, out);
+            return out.size();
+        };
+
+        BENCHMARK("radius 10, linear scan, n=" + std::to_string(count)) {
+            out.clear();
+            bruteForceRadius(manager, center, 10.0f, out);
+            return out.size();
+        };
+
+        BENCHMARK("8 nearest, spatial hash, n=" + std::to_string(count)) {
+            out.clear();
+            spatialQueryNearest(hash, center, 8, out);
+            return out.size();
+        };
+    }
+}
@@ -0,0 +1,43 @@
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/stream_buffer.h"
+#include "../common/stream.h"
+
+TEST_CASE("Stream buffer") {
+    StreamBuffer stream;
+    std::vector<std::uint8_t> memory;
+    initHostStream(stream, memory, 1 << 20);
+
+    Mat4 viewProj{};
+    std::vector<Mat4> models(4096);
+    std::vector<Mat4> fewModels(64);
+
+    // The cost of a frame only depends on what it uploads, not on how many frames came before,
+    // so 100 frames should take a tenth of 1000.
+    BENCHMARK("100 frames, 4096 instances") {
+        std::size_t sum = 0;
+        for (int frame = 0; frame < 100; ++frame) {
+            sum += streamFrame(stream, viewProj, models);
+        }
+        return sum;
+    };
+
+    BENCHMARK("1000 frames, 4096 instances") {
+        std::size_t sum = 0;
+        for (int frame = 0; frame < 1000; ++frame) {
+            sum += streamFrame(stream, viewProj, models);
+        }
+        return sum;
+    };
+
+    BENCHMARK("1000 frames, 64 instances") {
+        std::size_t sum = 0;
+        for (int frame = 0; frame < 1000; ++frame) {
+            sum += streamFrame(stream, viewProj, fewModels);
+        }
+        return sum;
+    };
+}
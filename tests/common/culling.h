@@ -0,0 +1,29 @@
+#ifndef TEST_CULLING_H
+#define TEST_CULLING_H
+
+#include <cstdint>
+#include <random>
+
+#include "../../src/graphics/culling.h"
+
+// Looking down at the origin from (0, 7, 5).
+inline Frustum makeCameraFrustum() {
+    Mat4 view = mat4_lookAt(Vector3{0, 7, 5}, Vector3{0, 0, 0}, {0, 1, 0});
+    Mat4 proj = mat4_perspective(1.5f, 16.0f / 9.0f, 0.1f, 100.0f);
+    return extractFrustum(proj * view);
+}
+
+// Spheres over a flat slab, [-extent, extent] on XZ and a tenth of that in height, the same ones
+// for the same arguments.
+inline void scatter(CullSpheres &spheres, std::uint32_t count, float extent) {
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> coord(-extent, extent);
+    std::uniform_real_distribution<float> radius(0.1f, 2.0f);
+
+    spheres.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        spheres.push(Vector3{coord(rng), coord(rng) * 0.1f, coord(rng)}, radius(rng));
+    }
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TEST_DUNGEON_H
+#define TEST_DUNGEON_H
+
+#include <cstdint>
+
+#include "../../src/core/jobs.h"
+#include "../../src/game/dungeon.h"
+
+// A width x height map of nothing but `fill`, to draw rooms and walls into.
+inline Dungeon makeDungeon(std::uint32_t width, std::uint32_t height, Tile fill = TILE_FLOOR) {
+    Dungeon dungeon;
+    dungeon.width = width;
+    dungeon.height = height;
+    dungeon.tiles.assign((std::size_t)width * height, fill);
+    return dungeon;
+}
+
+// A generated size x size dungeon, the same one every time.
+inline Dungeon makeTestDungeon(JobSystem &jobs, std::uint32_t size) {
+    DungeonConfig config;
+    config.width = size;
+    config.height = size;
+    config.seed = 9;
+
+    Dungeon dungeon;
+    generateDungeon(dungeon, config, jobs);
+    return dungeon;
+}
+
+#endif
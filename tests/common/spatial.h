@@ -0,0 +1,33 @@
+#ifndef TEST_SPATIAL_H
+#define TEST_SPATIAL_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../../src/game/entity.h"
+
+// Entities scattered over [-extent, extent] on XZ, the same ones for the same arguments.
+inline void populateScattered(EntityManager &manager, std::uint32_t count, float extent) {
+    std::mt19937 rng(1337);
+    std::uniform_real_distribution<float> coord(-extent, extent);
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        EntityId id = makeEntity(manager, EntityType::Enemy);
+        manager.positions[getEntityIndex(manager, id)] = Vector3{coord(rng), 0, coord(rng)};
+    }
+}
+
+// What spatialQueryRadius has to match.
+inline void bruteForceRadius(const EntityManager &manager, Vector3 center, float radius,
+                             std::vector<EntityId> &out) {
+    for (std::uint32_t i = 0; i < manager.count(); ++i) {
+        float dx = manager.positions[i].x - center.x;
+        float dz = manager.positions[i].z - center.z;
+        if ((dx * dx) + (dz * dz) <= radius * radius) {
+            out.push_back(manager.ids[i]);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef TEST_STREAM_H
+#define TEST_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../../src/core/math.h"
+#include "../../src/graphics/stream_buffer.h"
+
+// A persistent stream over host memory. Uploads are then the same memcpy as into a mapped buffer
+// and nothing calls GL as long as the regions never have to grow.
+inline void initHostStream(StreamBuffer &stream, std::vector<std::uint8_t> &memory,
+                           std::size_t regionSize) {
+    memory.assign(regionSize * STREAM_FRAMES, 0);
+    stream.persistent = true;
+    stream.mapped = memory.data();
+    stream.regionSize = regionSize;
+}
+
+// What uploadFrame in graphics.cpp does, with beginStreamFrame and endStreamFrame minus the
+// fences. Returns where the matrices went.
+inline std::size_t streamFrame(StreamBuffer &stream, const Mat4 &viewProj,
+                               const std::vector<Mat4> &models) {
+    stream.region = (std::uint32_t)(stream.frames % STREAM_FRAMES);
+    stream.head = 0;
+
+    std::size_t modelsSize = models.size() * sizeof(Mat4);
+    reserveStream(stream, sizeof(Mat4) + stream.uniformAlignment + modelsSize + sizeof(Mat4));
+    (void)uploadStream(stream, &viewProj, sizeof(Mat4), stream.uniformAlignment);
+    std::size_t modelsOffset = uploadStream(stream, models.data(), modelsSize, sizeof(Mat4));
+
+    stream.frames++;
+    return modelsOffset;
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef TEST_VERTICES_H
+#define TEST_VERTICES_H
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../../src/graphics/vertex_format.h"
+
+// Random positions in [-extent, extent], unit normals and UVs in [0, uvExtent]. The same ones for
+// the same arguments.
+inline std::vector<Vertex> makeVertices(std::uint32_t count, float extent, float uvExtent) {
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> coord(-extent, extent);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> uv(0.0f, uvExtent);
+
+    std::vector<Vertex> vertices(count);
+    for (Vertex &v : vertices) {
+        Vector3 n = Vector3{unit(rng), unit(rng), unit(rng)}.normalized();
+        v = Vertex{coord(rng), coord(rng), coord(rng), n.x, n.y, n.z, uv(rng), uv(rng)};
+    }
+    return vertices;
+}
+
+#endif
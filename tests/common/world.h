@@ -0,0 +1,41 @@
+#ifndef TEST_WORLD_H
+#define TEST_WORLD_H
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include "../../src/core/random.h"
+#include "../../src/game/simulation.h"
+
+// A world with everything a save has to carry: moving entities, holes in the sparse table left
+// by destroyed ones and some parented entities. The same seed every time.
+inline void populateWorld(Simulation &sim, std::uint32_t count) {
+    Random rng = makeRandom(7);
+    EntityManager &manager = sim.entities;
+
+    for (std::uint32_t i = 0; i < count; ++i) {
+        EntityId id = makeEntity(manager, i == 0 ? EntityType::Player : EntityType::Enemy);
+        std::uint32_t dense = getEntityIndex(manager, id);
+        manager.positions[dense] =
+            Vector3{randomRange(rng, -500, 500), 0, randomRange(rng, -500, 500)};
+        manager.velocities[dense] = Vector3{randomRange(rng, -1, 1), 0, randomRange(rng, -1, 1)};
+        manager.meshes[dense] = i % 3;
+    }
+
+    // leave some holes in the sparse table
+    for (std::uint32_t i = 0; i < count / 10; ++i) {
+        destroyEntity(manager, manager.ids[i * 7 % manager.count()]);
+    }
+
+    // and carry some entities along with others
+    for (std::uint32_t i = 1; i + 1 < manager.count(); i += 50) {
+        setParent(manager, manager.ids[i + 1], manager.ids[i]);
+    }
+}
+
+inline std::string tempPath(const char *name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+#endif
@@ -0,0 +1,37 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/culling.h"
+#include "../common/culling.h"
+
+TEST_CASE("Frustum planes bound what the camera sees") {
+    Frustum frustum = makeCameraFrustum();
+    CullSpheres spheres;
+    spheres.push(Vector3{0, 0, 0}, 0.5f);    // looked at
+    spheres.push(Vector3{0, 7, 20}, 0.5f);   // behind the camera
+    spheres.push(Vector3{0, 0, -200}, 0.5f); // past the far plane
+    spheres.push(Vector3{-80, 0, 0}, 0.5f);  // off to the side
+    spheres.push(Vector3{0, 0, -200}, 150);  // huge, reaches back in
+
+    std::vector<std::uint32_t> visible;
+    cullSpheres(frustum, spheres, visible);
+    REQUIRE(visible == std::vector<std::uint32_t>{0, 4});
+}
+
+TEST_CASE("SIMD culling matches the scalar version") {
+    Frustum frustum = makeCameraFrustum();
+
+    // odd count so the tail is exercised too
+    CullSpheres spheres;
+    scatter(spheres, 10007, 120.0f);
+
+    std::vector<std::uint32_t> simd;
+    std::vector<std::uint32_t> scalar;
+    cullSpheres(frustum, spheres, simd);
+    cullSpheresScalar(frustum, spheres, scalar);
+
+    REQUIRE(!scalar.empty());
+    REQUIRE(scalar.size() < spheres.count());
+    REQUIRE(simd == scalar);
+}
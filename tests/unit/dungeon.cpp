@@ -0,0 +1,81 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/dungeon.h"
+
+static std::uint64_t generateWith(std::uint32_t workers, const DungeonConfig &config) {
+    JobSystem jobs;
+    initJobSystem(jobs, workers);
+
+    Dungeon dungeon;
+    generateDungeon(dungeon, config, jobs);
+    shutdownJobSystem(jobs);
+
+    return checksumDungeon(dungeon);
+}
+
+static std::uint32_t countReachable(const Dungeon &dungeon, std::uint32_t x, std::uint32_t y) {
+    std::vector<bool> seen(dungeon.tiles.size(), false);
+    std::vector<std::uint32_t> stack = {y * dungeon.width + x};
+    seen[stack[0]] = true;
+
+    std::uint32_t reached = 0;
+    while (!stack.empty()) {
+        std::uint32_t tile = stack.back();
+        stack.pop_back();
+        ++reached;
+
+        std::uint32_t tx = tile % dungeon.width;
+        std::uint32_t ty = tile / dungeon.width;
+        std::uint32_t neighbours[4] = {tile - 1, tile + 1, tile - dungeon.width,
+                                       tile + dungeon.width};
+        bool valid[4] = {tx > 0, tx + 1 < dungeon.width, ty > 0, ty + 1 < dungeon.height};
+
+        for (int i = 0; i < 4; ++i) {
+            if (valid[i] && !seen[neighbours[i]] && dungeon.tiles[neighbours[i]] == TILE_FLOOR) {
+                seen[neighbours[i]] = true;
+                stack.push_back(neighbours[i]);
+            }
+        }
+    }
+    return reached;
+}
+
+TEST_CASE("Dungeons only depend on the seed, not the worker count") {
+    DungeonConfig config;
+    config.seed = 42;
+
+    std::uint64_t single = generateWith(1, config);
+    REQUIRE(single == generateWith(4, config));
+
+    config.seed = 43;
+    REQUIRE(single != generateWith(4, config));
+}
+
+TEST_CASE("Every floor tile is reachable from the player") {
+    DungeonConfig config;
+    config.width = 200; // not a multiple of the chunk size
+    config.height = 130;
+
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    Dungeon dungeon;
+    generateDungeon(dungeon, config, jobs);
+
+    REQUIRE(dungeon.spawns.size() >= 1);
+    REQUIRE(dungeon.spawns[0].type == EntityType::Player);
+
+    std::uint32_t floor = 0;
+    for (std::uint8_t tile : dungeon.tiles) {
+        floor += tile == TILE_FLOOR;
+    }
+    REQUIRE(countReachable(dungeon, dungeon.spawns[0].x, dungeon.spawns[0].y) == floor);
+
+    for (const DungeonSpawn &spawn : dungeon.spawns) {
+        REQUIRE(dungeon.at(spawn.x, spawn.y) == TILE_FLOOR);
+    }
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,37 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/dungeon_edit.h"
+#include "../common/dungeon.h"
+
+TEST_CASE("Editing a tile marks its chunk dirty and keeps the field and view in step") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    Dungeon dungeon = makeDungeon(64, 64);
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, 32);
+
+    FlowField field;
+    initFlowField(field, dungeon);
+    REQUIRE(updateFlowField(field, dungeon, 10, 10, jobs));
+
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 8);
+    REQUIRE(updateFieldOfView(fov, dungeon, 10, 10));
+
+    // right next to the viewer, well inside chunk 0
+    editDungeonTile(dungeon, field, fov, mesher, 12, 10, TILE_WALL);
+    REQUIRE(dungeon.at(12, 10) == TILE_WALL);
+    REQUIRE(field.directions[10 * 64 + 12] == FLOW_NONE);
+    REQUIRE(fov.dirty);
+    REQUIRE(mesher.chunks[0].dirty);
+    REQUIRE_FALSE(mesher.chunks[1].dirty);
+
+    // setting a tile to what it already is changes nothing, not even after the chunk was rebuilt
+    mesher.chunks[0].dirty = false;
+    editDungeonTile(dungeon, field, fov, mesher, 12, 10, TILE_WALL);
+    REQUIRE_FALSE(mesher.chunks[0].dirty);
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/dungeon.h"
+#include "../../src/game/dungeon_mesh.h"
+#include "../common/dungeon.h"
+
+struct FaceCounts {
+    std::uint32_t quads = 0;
+    float floorArea = 0; // tops at y = 0
+    float wallTopArea = 0;
+    float sideArea = 0;
+    std::uint32_t sides[4] = {}; // -x, +x, -z, +z
+};
+
+// Quads are four vertices each, the corners are p, p + b, p + a + b, p + a.
+static FaceCounts countFaces(const std::vector<Vertex> &vertices,
+                             const std::vector<unsigned int> &indices) {
+    REQUIRE(vertices.size() % 4 == 0);
+    REQUIRE(indices.size() == vertices.size() / 4 * 6);
+
+    FaceCounts counts;
+    for (std::size_t q = 0; q < vertices.size(); q += 4) {
+        const Vertex &p = vertices[q];
+        const Vertex &o = vertices[q + 2];
+        float dx = std::abs(o.px - p.px);
+        float dy = std::abs(o.py - p.py);
+        float dz = std::abs(o.pz - p.pz);
+        counts.quads++;
+
+        if (p.ny > 0) {
+            (p.py == 0 ? counts.floorArea : counts.wallTopArea) += dx * dz;
+        } else {
+            counts.sideArea += (dx + dz) * dy;
+            int side = p.nx < 0 ? 0 : p.nx > 0 ? 1 : p.nz < 0 ? 2 : 3;
+            counts.sides[side]++;
+        }
+    }
+    return counts;
+}
+
+static FaceCounts meshWhole(const Dungeon &dungeon, const DungeonMesher &mesher) {
+    FaceCounts total;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    DungeonChunkTiles tiles;
+    for (std::uint32_t chunk = 0; chunk < mesher.chunks.size(); ++chunk) {
+        copyDungeonChunk(dungeon, mesher, chunk, tiles);
+        buildDungeonChunkGeometry(tiles, vertices, indices);
+
+        FaceCounts counts = countFaces(vertices, indices);
+        total.quads += counts.quads;
+        total.floorArea += counts.floorArea;
+        total.wallTopArea += counts.wallTopArea;
+        total.sideArea += counts.sideArea;
+        for (int side = 0; side < 4; ++side) {
+            total.sides[side] += counts.sides[side];
+        }
+    }
+    return total;
+}
+
+TEST_CASE("Greedy meshing merges a room into single quads") {
+    // a 6x4 room in walls
+    Dungeon dungeon = makeDungeon(8, 6, TILE_WALL);
+    for (std::uint32_t y = 1; y < 5; ++y) {
+        for (std::uint32_t x = 1; x < 7; ++x) {
+            dungeon.tiles[y * dungeon.width + x] = TILE_FLOOR;
+        }
+    }
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, 32);
+    FaceCounts counts = meshWhole(dungeon, mesher);
+
+    REQUIRE(counts.floorArea == 24.0f);
+    REQUIRE(counts.wallTopArea == 48.0f - 24.0f);
+    // one quad per wall facing the room
+    for (std::uint32_t side : counts.sides) {
+        REQUIRE(side == 1);
+    }
+    REQUIRE(counts.sideArea == (6 + 6 + 4 + 4) * DUNGEON_WALL_HEIGHT);
+    // the floor, four sides and the ring of wall tops, which greedy meshing covers in four
+    REQUIRE(counts.quads == 1 + 4 + 4);
+}
+
+TEST_CASE("A lone wall gets four sides and hidden faces are culled") {
+    Dungeon dungeon = makeDungeon(5, 5, TILE_FLOOR);
+    dungeon.tiles[2 * dungeon.width + 2] = TILE_WALL;
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, 32);
+    FaceCounts counts = meshWhole(dungeon, mesher);
+
+    REQUIRE(counts.floorArea == 24.0f);
+    REQUIRE(counts.wallTopArea == 1.0f);
+    for (std::uint32_t side : counts.sides) {
+        REQUIRE(side == 1);
+    }
+    REQUIRE(counts.sideArea == 4 * DUNGEON_WALL_HEIGHT);
+
+    // solid rock has nothing but its top, the map edge counts as wall
+    Dungeon rock = makeDungeon(40, 40, TILE_WALL);
+    initDungeonMesher(mesher, rock, 32);
+    counts = meshWhole(rock, mesher);
+    REQUIRE(counts.quads == 4); // one top per chunk
+    REQUIRE(counts.sideArea == 0.0f);
+}
+
+TEST_CASE("Chunk meshes cover every tile of a generated dungeon") {
+    DungeonConfig config;
+    config.width = 200;
+    config.height = 130;
+
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    Dungeon dungeon;
+    generateDungeon(dungeon, config, jobs);
+
+    std::uint32_t floor = 0;
+    for (std::uint8_t tile : dungeon.tiles) {
+        floor += tile == TILE_FLOOR;
+    }
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, config.chunkSize);
+    REQUIRE(mesher.chunks.size() == 7 * 5);
+
+    FaceCounts counts = meshWhole(dungeon, mesher);
+    REQUIRE(counts.floorArea == (float)floor);
+    REQUIRE(counts.wallTopArea == (float)(dungeon.tiles.size() - floor));
+    // greedy meshing needs far fewer quads than one per tile
+    REQUIRE(counts.quads < dungeon.tiles.size() / 4);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Edited tiles remesh their chunks in the background") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    Dungeon dungeon = makeDungeon(64, 64, TILE_FLOOR);
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, 32);
+    for (std::uint32_t chunk = 0; chunk < mesher.chunks.size(); ++chunk) {
+        mesher.chunks[chunk].mesh = 100 + chunk;
+    }
+
+    MeshUploadQueue uploads;
+    remeshDirtyChunks(mesher, dungeon, jobs, uploads);
+    waitForCounter(jobs, mesher.building);
+    REQUIRE(uploads.pending.empty());
+
+    // on the edge between chunks 0 and 1, the neighbour is remeshed too since a wall there could
+    // have been facing the tile
+    dungeon.tiles[5 * dungeon.width + 31] = TILE_WALL;
+    markDungeonTileDirty(mesher, 31, 5);
+    remeshDirtyChunks(mesher, dungeon, jobs, uploads);
+    waitForCounter(jobs, mesher.building);
+
+    REQUIRE(uploads.pending.size() == 2);
+    std::vector<MeshId> meshes;
+    for (const MeshUpload &upload : uploads.pending) {
+        meshes.push_back(upload.mesh);
+        REQUIRE(!upload.indices.empty());
+    }
+    std::sort(meshes.begin(), meshes.end());
+    REQUIRE(meshes == std::vector<MeshId>{100, 101});
+
+    for (std::uint32_t chunk = 0; chunk < 2; ++chunk) {
+        const DungeonChunkMesh &mesh = mesher.chunks[chunk];
+        REQUIRE(!mesh.dirty);
+        REQUIRE(!mesh.building);
+        REQUIRE(mesh.builds == 1);
+        REQUIRE(mesh.triangles > 0);
+    }
+    REQUIRE(mesher.chunks[2].builds == 0);
+
+    // chunk 0 has the floor around the wall in three quads plus the wall's top and four sides,
+    // chunk 1 is still a single floor quad
+    std::size_t expected[2] = {(3 + 1 + 4) * 2, 2};
+    for (const MeshUpload &upload : uploads.pending) {
+        REQUIRE(upload.indices.size() / 3 == expected[upload.mesh - 100]);
+    }
+
+    shutdownJobSystem(jobs);
+}
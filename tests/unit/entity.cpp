@@ -0,0 +1,154 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/commands.h"
+#include "../../src/game/entity.h"
+
+TEST_CASE("Entities are addressed by generational handles") {
+    EntityManager manager;
+
+    EntityId a = makeEntity(manager, EntityType::Player);
+    EntityId b = makeEntity(manager, EntityType::Enemy);
+
+    REQUIRE(manager.count() == 2);
+    REQUIRE(isEntityAlive(manager, a));
+    REQUIRE(isEntityAlive(manager, b));
+
+    destroyEntity(manager, a);
+    REQUIRE_FALSE(isEntityAlive(manager, a));
+    REQUIRE(getEntityIndex(manager, a) == ENTITY_INVALID_INDEX);
+
+    // the slot is recycled with a new generation, the old handle stays stale
+    EntityId c = makeEntity(manager, EntityType::Enemy);
+    REQUIRE(entityIdIndex(c) == entityIdIndex(a));
+    REQUIRE(entityIdGeneration(c) != entityIdGeneration(a));
+    REQUIRE_FALSE(isEntityAlive(manager, a));
+    REQUIRE(isEntityAlive(manager, c));
+
+    // destroying a stale handle must not touch the live entity in that slot
+    destroyEntity(manager, a);
+    REQUIRE(isEntityAlive(manager, c));
+}
+
+TEST_CASE("Destroying an entity keeps the columns packed") {
+    EntityManager manager;
+
+    EntityId ids[4];
+    for (int i = 0; i < 4; ++i) {
+        ids[i] = makeEntity(manager, i == 0 ? EntityType::Player : EntityType::Enemy);
+        manager.positions[getEntityIndex(manager, ids[i])] = Vector3{(float)i, 0, 0};
+    }
+
+    destroyEntity(manager, ids[1]);
+
+    REQUIRE(manager.count() == 3);
+    for (int i : {0, 2, 3}) {
+        std::uint32_t dense = getEntityIndex(manager, ids[i]);
+        REQUIRE(dense < manager.count());
+        REQUIRE(manager.ids[dense] == ids[i]);
+        REQUIRE(manager.positions[dense].x == (float)i);
+    }
+
+    destroyAllEntities(manager);
+    REQUIRE(manager.count() == 0);
+    REQUIRE_FALSE(isEntityAlive(manager, ids[0]));
+}
+
+TEST_CASE("Command buffers defer structural changes until applied") {
+    EntityManager manager;
+    EntityCommandBuffer commands;
+
+    EntityId existing = makeEntity(manager, EntityType::Enemy);
+
+    EntityId spawned =
+        recordCreateEntity(commands, manager, EntityType::Enemy, Vector3{1, 2, 3}, Vector3{2, 2, 2});
+    recordDestroyEntity(commands, existing);
+    recordDestroyEntity(commands, existing);
+
+    REQUIRE(manager.count() == 1);
+    REQUIRE(isEntityAlive(manager, existing));
+    REQUIRE_FALSE(isEntityAlive(manager, spawned));
+
+    applyEntityCommands(commands, manager);
+
+    REQUIRE(commands.empty());
+    REQUIRE(manager.count() == 1);
+    REQUIRE_FALSE(isEntityAlive(manager, existing));
+    REQUIRE(isEntityAlive(manager, spawned));
+
+    std::uint32_t dense = getEntityIndex(manager, spawned);
+    REQUIRE(manager.positions[dense].y == 2.0f);
+    REQUIRE(manager.scales[dense].x == 2.0f);
+}
+
+TEST_CASE("Mass despawn through a command buffer empties the store") {
+    EntityManager manager;
+    EntityCommandBuffer commands;
+
+    for (int i = 0; i < 10000; ++i) {
+        (void)makeEntity(manager, EntityType::Enemy);
+    }
+
+    for (EntityId id : manager.ids) {
+        recordDestroyEntity(commands, id);
+    }
+    applyEntityCommands(commands, manager);
+
+    REQUIRE(manager.count() == 0);
+    REQUIRE(manager.freeIndices.size() == 10000);
+}
+
+static void requireQueryConsistent(const EntityManager &manager, const EntityQuery &query) {
+    std::uint32_t expected = 0;
+    for (std::uint32_t dense = 0; dense < manager.count(); ++dense) {
+        if (query.matches(manager.signatures[dense])) {
+            expected++;
+            REQUIRE(query.slots[dense] != ENTITY_INVALID_INDEX);
+            REQUIRE(query.dense[query.slots[dense]] == dense);
+        } else {
+            REQUIRE(query.slots[dense] == ENTITY_INVALID_INDEX);
+        }
+    }
+    REQUIRE(query.count() == expected);
+}
+
+TEST_CASE("Queries track matching entities incrementally") {
+    EntityManager manager;
+
+    EntityId player = makeEntity(manager, EntityType::Player);
+    EntityId enemies[6];
+    for (EntityId &enemy : enemies) {
+        enemy = makeEntity(manager, EntityType::Enemy);
+    }
+
+    // registered after spawning, filled from the existing rows
+    EntityQuery *movingEnemies =
+        registerQuery(manager, componentBit(COMPONENT_ENEMY) | componentBit(COMPONENT_VELOCITY),
+                      componentBit(COMPONENT_PLAYER));
+    EntityQuery *players = registerQuery(manager, componentBit(COMPONENT_PLAYER));
+
+    REQUIRE(registerQuery(manager, componentBit(COMPONENT_PLAYER)) == players);
+    REQUIRE(movingEnemies->count() == 6);
+    REQUIRE(players->count() == 1);
+
+    removeComponent(manager, enemies[2], COMPONENT_VELOCITY);
+    REQUIRE_FALSE(hasComponent(manager, enemies[2], COMPONENT_VELOCITY));
+    REQUIRE(movingEnemies->count() == 5);
+
+    // an entity can carry several tags, the `none` mask excludes it
+    addComponent(manager, enemies[3], COMPONENT_PLAYER);
+    REQUIRE(movingEnemies->count() == 4);
+    REQUIRE(players->count() == 2);
+
+    destroyEntity(manager, enemies[0]);
+    destroyEntity(manager, player);
+    (void)makeEntity(manager, EntityType::Enemy);
+
+    REQUIRE(movingEnemies->count() == 4);
+    REQUIRE(players->count() == 1);
+    requireQueryConsistent(manager, *movingEnemies);
+    requireQueryConsistent(manager, *players);
+
+    destroyAllEntities(manager);
+    REQUIRE(movingEnemies->count() == 0);
+    REQUIRE(players->count() == 0);
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/fov.h"
+#include "../common/dungeon.h"
+
+TEST_CASE("Tile bitsets pack 8x8 blocks into one word") {
+    TileBitset bits;
+    REQUIRE(testTile(bits, 3, 4)); // empty means everything
+
+    initTileBitset(bits, 20, 10);
+    REQUIRE(bits.words.size() == 3 * 2);
+
+    setTile(bits, 7, 7);
+    setTile(bits, 8, 7);
+    setTile(bits, 19, 9);
+    REQUIRE(bits.words[0] == 1ull << 63);
+    REQUIRE(testTile(bits, 8, 7));
+    REQUIRE(testTile(bits, 19, 9));
+    REQUIRE_FALSE(testTile(bits, 9, 7));
+    REQUIRE_FALSE(testTile(bits, 20, 9));
+
+    REQUIRE(testPosition(bits, Vector3{7.9f, 0, 7.2f}));
+    REQUIRE_FALSE(testPosition(bits, Vector3{-3, 0, 0}));
+}
+
+TEST_CASE("An open floor is visible up to the radius") {
+    Dungeon dungeon = makeDungeon(64, 64);
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 10);
+    REQUIRE(updateFieldOfView(fov, dungeon, 30, 30));
+
+    for (std::uint32_t y = 0; y < 64; ++y) {
+        for (std::uint32_t x = 0; x < 64; ++x) {
+            int dx = (int)x - 30;
+            int dy = (int)y - 30;
+            REQUIRE(testTile(fov.visible, x, y) == (dx * dx + dy * dy <= 100));
+        }
+    }
+}
+
+TEST_CASE("Walls cast shadows") {
+    Dungeon dungeon = makeDungeon(32, 32);
+    // a wall segment east of the viewer
+    for (std::uint32_t y = 14; y <= 18; ++y) {
+        dungeon.tiles[y * 32 + 20] = TILE_WALL;
+    }
+
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 12);
+    updateFieldOfView(fov, dungeon, 16, 16);
+
+    REQUIRE(testTile(fov.visible, 20, 16)); // the wall itself
+    REQUIRE_FALSE(testTile(fov.visible, 21, 16));
+    REQUIRE_FALSE(testTile(fov.visible, 25, 16));
+    REQUIRE(testTile(fov.visible, 16, 26));
+}
+
+TEST_CASE("Moving keeps explored tiles and matches a fresh view") {
+    Dungeon dungeon = makeDungeon(100, 40);
+    for (std::uint32_t x = 10; x < 90; x += 7) {
+        dungeon.tiles[20 * 100 + x] = TILE_WALL;
+    }
+
+    FieldOfView moving;
+    initFieldOfView(moving, dungeon, 9);
+    for (std::uint32_t x = 5; x < 95; x += 3) {
+        updateFieldOfView(moving, dungeon, x, 18);
+
+        FieldOfView fresh;
+        initFieldOfView(fresh, dungeon, 9);
+        updateFieldOfView(fresh, dungeon, x, 18);
+        REQUIRE(moving.visible.words == fresh.visible.words);
+    }
+
+    REQUIRE(testTile(moving.explored, 5, 18));
+    REQUIRE_FALSE(testTile(moving.visible, 5, 18));
+}
+
+TEST_CASE("Field of view only recomputes when something it can see changes") {
+    Dungeon dungeon = makeDungeon(64, 64);
+    FieldOfView fov;
+    initFieldOfView(fov, dungeon, 8);
+
+    REQUIRE(updateFieldOfView(fov, dungeon, 10, 10));
+    REQUIRE_FALSE(updateFieldOfView(fov, dungeon, 10, 10));
+
+    invalidateFieldOfView(fov, 40, 40);
+    REQUIRE_FALSE(updateFieldOfView(fov, dungeon, 10, 10));
+
+    dungeon.tiles[10 * 64 + 12] = TILE_WALL;
+    invalidateFieldOfView(fov, 12, 10);
+    REQUIRE(updateFieldOfView(fov, dungeon, 10, 10));
+    REQUIRE_FALSE(testTile(fov.visible, 13, 10));
+
+    REQUIRE(updateFieldOfView(fov, dungeon, 11, 10));
+    REQUIRE(fov.recomputes == 3);
+}
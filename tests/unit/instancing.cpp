@@ -0,0 +1,122 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/graphics.h"
+
+static void addRow(RenderSnapshot &snapshot, EntityType type, Vector3 position, MeshId mesh) {
+    snapshot.ids.push_back((EntityId)snapshot.ids.size());
+    snapshot.signatures.push_back(getEntityTypeSignature(type));
+    snapshot.positions.push_back(position);
+    snapshot.scales.push_back(Vector3{1, 1, 1});
+    snapshot.transforms.push_back(mat4_translate(position));
+    snapshot.meshes.push_back(mesh);
+}
+
+TEST_CASE("Instances are bucketed by mesh") {
+    RenderSnapshot snapshot;
+    addRow(snapshot, EntityType::Enemy, Vector3{1, 0, 0}, 2);
+    addRow(snapshot, EntityType::Prop, Vector3{0, 0, 0}, 0);
+    addRow(snapshot, EntityType::Player, Vector3{4, 0, 6}, 2);
+    addRow(snapshot, EntityType::Enemy, Vector3{3, 0, 0}, 2);
+
+    InstanceBatches batches;
+    buildInstanceBatches(snapshot, snapshot.positions, 1.0f, 1, nullptr, batches);
+
+    REQUIRE(batches.batches.size() == 2);
+    REQUIRE(batches.batches[0].mesh == 0);
+    REQUIRE(batches.batches[0].count == 1);
+    REQUIRE(batches.batches[1].mesh == 2);
+    REQUIRE(batches.batches[1].first == 1);
+    REQUIRE(batches.batches[1].count == 3);
+
+    // translation lives in the last column, in row order within the bucket
+    REQUIRE(batches.models[1].entries[3][0] == 1.0f);
+    REQUIRE(batches.models[2].entries[3][0] == 4.0f);
+    REQUIRE(batches.models[3].entries[3][0] == 3.0f);
+    REQUIRE(batches.models[3].entries[3][3] == 1.0f);
+
+    Vector3 target;
+    REQUIRE(findCameraTarget(snapshot, snapshot.positions, 1.0f, target));
+    REQUIRE(target.z == 6.0f);
+}
+
+TEST_CASE("Instances interpolate and skip actors outside the view") {
+    RenderSnapshot snapshot;
+    addRow(snapshot, EntityType::Player, Vector3{2, 0, 2}, 0);
+    addRow(snapshot, EntityType::Enemy, Vector3{3, 0, 2}, 0);
+    addRow(snapshot, EntityType::Enemy, Vector3{30, 0, 30}, 0);
+    addRow(snapshot, EntityType::Prop, Vector3{30, 0, 30}, 1);
+
+    initTileBitset(snapshot.visible, 40, 40);
+    setTile(snapshot.visible, 2, 2);
+    setTile(snapshot.visible, 3, 2);
+
+    std::vector<Vector3> previous = snapshot.positions;
+    previous[0] = Vector3{0, 0, 2};
+
+    InstanceBatches batches;
+    buildInstanceBatches(snapshot, previous, 0.5f, 1, nullptr, batches);
+
+    REQUIRE(batches.batches.size() == 2);
+    REQUIRE(batches.batches[0].count == 2); // player and the visible enemy
+    REQUIRE(batches.batches[1].count == 1); // props are never hidden
+    REQUIRE(batches.models[0].entries[3][0] == 1.0f);
+}
+
+TEST_CASE("Instance models are the world transforms with the blended position") {
+    RenderSnapshot snapshot;
+    addRow(snapshot, EntityType::Prop, Vector3{4, 1, 2}, 0);
+    snapshot.transforms[0] = mat4_translate(Vector3{4, 1, 2}) * mat4_scale(Vector3{2, 3, 0.5f});
+
+    std::vector<Vector3> previous = {Vector3{2, 1, 2}};
+
+    InstanceBatches batches;
+    buildInstanceBatches(snapshot, previous, 0.5f, 1, nullptr, batches);
+
+    // column-major, the scale sits on the diagonal and the last column is the position
+    const Mat4 &model = batches.models[0];
+    REQUIRE(model.entries[0][0] == 2.0f);
+    REQUIRE(model.entries[1][1] == 3.0f);
+    REQUIRE(model.entries[2][2] == 0.5f);
+    REQUIRE(model.entries[3][0] == 3.0f);
+    REQUIRE(model.entries[3][1] == 1.0f);
+    REQUIRE(model.entries[3][3] == 1.0f);
+}
+
+TEST_CASE("Instances outside the frustum are culled") {
+    RenderSnapshot snapshot;
+    addRow(snapshot, EntityType::Player, Vector3{0, 0, 0}, 0);
+    addRow(snapshot, EntityType::Enemy, Vector3{2, 0, -3}, 0);
+    addRow(snapshot, EntityType::Enemy, Vector3{0, 0, 40}, 0); // behind the camera
+    addRow(snapshot, EntityType::Enemy, Vector3{500, 0, 0}, 0);
+
+    Mat4 view = mat4_lookAt(Vector3{0, 7, 5}, Vector3{0, 0, 0}, {0, 1, 0});
+    Mat4 proj = mat4_perspective(1.5f, 16.0f / 9.0f, 0.1f, 100.0f);
+
+    InstanceCulling culling;
+    culling.frustum = extractFrustum(proj * view);
+    culling.meshBounds.push_back(MeshBounds{{0, 0, 0}, {1, 1, 1}, {0.5f, 0.5f, 0.5f}, 0.87f});
+
+    InstanceBatches batches;
+    buildInstanceBatches(snapshot, snapshot.positions, 1.0f, 1, &culling, batches);
+
+    REQUIRE(batches.culled == 2);
+    REQUIRE(batches.batches.size() == 1);
+    REQUIRE(batches.batches[0].count == 2);
+    REQUIRE(batches.models[1].entries[3][0] == 2.0f);
+}
+
+TEST_CASE("Far away instances draw coarser LODs") {
+    MeshLodErrors lods;
+    lods.errors[1] = 0.01f;
+    lods.errors[2] = 0.05f;
+    lods.count = 3;
+
+    // 360 pixels per unit at distance 1, a 1 pixel budget
+    REQUIRE(selectMeshLod(lods, 1.0f, 1.0f, 360.0f, 1.0f) == 0);
+    REQUIRE(selectMeshLod(lods, 1.0f, 5.0f, 360.0f, 1.0f) == 1);
+    REQUIRE(selectMeshLod(lods, 1.0f, 20.0f, 360.0f, 1.0f) == 2);
+    // twice the size looks like half the distance
+    REQUIRE(selectMeshLod(lods, 2.0f, 20.0f, 360.0f, 1.0f) == 1);
+}
@@ -0,0 +1,51 @@
+#include <atomic>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/jobs.h"
+
+TEST_CASE("parallelFor visits every index exactly once") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    std::vector<std::uint32_t> hits(100000, 0);
+    parallelFor(jobs, 0, (std::uint32_t)hits.size(), 1024,
+                [&](std::uint32_t begin, std::uint32_t end) {
+                    for (std::uint32_t i = begin; i < end; ++i) {
+                        hits[i]++;
+                    }
+                });
+
+    for (std::uint32_t hit : hits) {
+        REQUIRE(hit == 1);
+    }
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Dependent jobs run after their dependency reaches zero") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    std::atomic<int> produced{0};
+    std::atomic<int> seenByConsumer{-1};
+
+    JobCounter producers;
+    JobCounter done;
+
+    for (int i = 0; i < 64; ++i) {
+        submitJob(jobs, [&] { produced++; }, &producers);
+    }
+    submitJobAfter(jobs, producers, [&] { seenByConsumer = produced.load(); }, &done);
+
+    waitForCounter(jobs, done);
+    REQUIRE(seenByConsumer == 64);
+
+    // a dependency that is already satisfied runs right away
+    submitJobAfter(jobs, producers, [&] { seenByConsumer = 0; }, &done);
+    waitForCounter(jobs, done);
+    REQUIRE(seenByConsumer == 0);
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,79 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/mesh.h"
+
+TEST_CASE("Released arena ranges merge with their neighbours") {
+    std::vector<ArenaRange> free;
+    releaseArenaRange(free, 100, 10);
+    releaseArenaRange(free, 0, 10);
+    releaseArenaRange(free, 50, 10);
+    REQUIRE(free.size() == 3);
+    REQUIRE(free[0].start == 0);
+    REQUIRE(free[1].start == 50);
+    REQUIRE(free[2].start == 100);
+
+    // touches both 50..60 and 100..110 once 60..100 is back
+    releaseArenaRange(free, 60, 40);
+    REQUIRE(free.size() == 2);
+    REQUIRE(free[1].start == 50);
+    REQUIRE(free[1].count == 60);
+
+    releaseArenaRange(free, 10, 40);
+    REQUIRE(free.size() == 1);
+    REQUIRE(free[0].start == 0);
+    REQUIRE(free[0].count == 110);
+}
+
+TEST_CASE("Claims take the first free range that fits and split it") {
+    std::vector<ArenaRange> free;
+    releaseArenaRange(free, 0, 8);
+    releaseArenaRange(free, 20, 32);
+
+    unsigned int start = 1234;
+    REQUIRE(!claimArenaRange(free, 40, start));
+    REQUIRE(start == 1234);
+    REQUIRE(!claimArenaRange(free, 0, start));
+
+    REQUIRE(claimArenaRange(free, 16, start));
+    REQUIRE(start == 20);
+    REQUIRE(claimArenaRange(free, 8, start));
+    REQUIRE(start == 0);
+    REQUIRE(free.size() == 1);
+    REQUIRE(free[0].start == 36);
+    REQUIRE(free[0].count == 16);
+
+    REQUIRE(claimArenaRange(free, 16, start));
+    REQUIRE(start == 36);
+    REQUIRE(free.empty());
+}
+
+TEST_CASE("A range that keeps moving reuses the space it left behind") {
+    // what updateMesh does for a chunk that grows on every edit: release, then claim twice the
+    // new size, appending only when nothing free is big enough
+    std::vector<ArenaRange> free;
+    unsigned int end = 0;
+    unsigned int start = 0;
+    unsigned int capacity = 0;
+
+    for (unsigned int size = 1; size <= 64; ++size) {
+        releaseArenaRange(free, start, capacity);
+        // like releaseMeshSpace, a free range at the end shrinks the arena
+        if (!free.empty() && free.back().start + free.back().count == end) {
+            end = free.back().start;
+            free.pop_back();
+        }
+
+        capacity = size * 2;
+        if (!claimArenaRange(free, capacity, start)) {
+            start = end;
+            end += capacity;
+        }
+    }
+
+    // the only mesh in the arena always ends up at the start
+    REQUIRE(start == 0);
+    REQUIRE(end == capacity);
+    REQUIRE(free.empty());
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/mesh.h"
+#include "../../src/graphics/mesh_optimize.h"
+
+// Two triangles per cell of an n x n vertex grid.
+static std::vector<unsigned int> makeGrid(unsigned int n) {
+    std::vector<unsigned int> indices;
+    for (unsigned int y = 0; y + 1 < n; ++y) {
+        for (unsigned int x = 0; x + 1 < n; ++x) {
+            unsigned int a = y * n + x;
+            indices.insert(indices.end(), {a, a + n, a + n + 1, a, a + n + 1, a + 1});
+        }
+    }
+    return indices;
+}
+
+static std::vector<std::array<unsigned int, 3>> sortedTriangles(
+    const std::vector<unsigned int> &indices) {
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        triangles.push_back({indices[i], indices[i + 1], indices[i + 2]});
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+TEST_CASE("Vertex cache ordering lowers the ACMR and keeps every triangle") {
+    const unsigned int n = 64;
+    std::vector<unsigned int> indices = makeGrid(n);
+
+    // worst case input, triangles in random order
+    std::vector<std::array<unsigned int, 3>> triangles = sortedTriangles(indices);
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(20));
+    indices.clear();
+    for (const auto &triangle : triangles) {
+        indices.insert(indices.end(), triangle.begin(), triangle.end());
+    }
+
+    float before = computeAcmr(indices.data(), indices.size(), n * n);
+    optimizeVertexCache(indices.data(), indices.size(), n * n);
+    float after = computeAcmr(indices.data(), indices.size(), n * n);
+
+    REQUIRE(before > 2.0f);
+    REQUIRE(after < 0.8f);
+    REQUIRE(sortedTriangles(indices) == sortedTriangles(makeGrid(n)));
+}
+
+TEST_CASE("OBJ corners with the same v/vt/vn share a vertex") {
+    const char *quad = "v 0 0 0\n"
+                       "v 1 0 0\n"
+                       "v 1 1 0\n"
+                       "v 0 1 0\n"
+                       "vn 0 0 1\n"
+                       "vn 0 0 -1\n"
+                       "f 1//1 2//1 3//1 4//1\n" // fan, 2 triangles over 4 corners
+                       "f 1//2 3//2 2//2\n";     // same positions, other normal
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    REQUIRE(parseObj(quad, vertices, indices));
+    REQUIRE(vertices.size() == 7);
+    REQUIRE(indices == std::vector<unsigned int>{0, 1, 2, 0, 2, 3, 4, 5, 6});
+    REQUIRE(vertices[4].nz == -1.0f);
+}
+
+static Vector3 cornerNormal(const std::vector<Vertex> &vertices, const unsigned int *triangle) {
+    Vector3 a{vertices[triangle[0]].px, vertices[triangle[0]].py, vertices[triangle[0]].pz};
+    Vector3 b{vertices[triangle[1]].px, vertices[triangle[1]].py, vertices[triangle[1]].pz};
+    Vector3 c{vertices[triangle[2]].px, vertices[triangle[2]].py, vertices[triangle[2]].pz};
+    Vector3 ab = b - a;
+    Vector3 ac = c - a;
+    return Vector3{ab.y * ac.z - ab.z * ac.y, ab.z * ac.x - ab.x * ac.z, ab.x * ac.y - ab.y * ac.x};
+}
+
+TEST_CASE("Simplifying a flat grid is free and keeps its border") {
+    const unsigned int n = 32;
+    std::vector<Vertex> vertices;
+    for (unsigned int y = 0; y < n; ++y) {
+        for (unsigned int x = 0; x < n; ++x) {
+            vertices.push_back(Vertex{(float)x, 0, (float)y, 0, 1, 0, 0, 0});
+        }
+    }
+    std::vector<unsigned int> indices = makeGrid(n);
+
+    std::vector<unsigned int> simplified;
+    float error = simplifyMesh(vertices.data(), n * n, indices.data(), indices.size(),
+                               indices.size() / 4, 1.0f, simplified);
+
+    REQUIRE(error < 1e-4f);
+    REQUIRE(simplified.size() <= indices.size() / 4);
+    REQUIRE(simplified.size() % 3 == 0);
+
+    // still facing the same way, and every border vertex is still used
+    std::vector<bool> used(n * n, false);
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        REQUIRE(cornerNormal(vertices, &simplified[i]).y > 0.0f);
+        used[simplified[i]] = used[simplified[i + 1]] = used[simplified[i + 2]] = true;
+    }
+    for (unsigned int i = 0; i < n; ++i) {
+        REQUIRE(used[i]);
+        REQUIRE(used[(n - 1) * n + i]);
+        REQUIRE(used[i * n]);
+        REQUIRE(used[i * n + n - 1]);
+    }
+}
+
+TEST_CASE("Simplifying a sphere stays close to its surface") {
+    // latitude/longitude sphere without seams, the poles are single vertices
+    const unsigned int rings = 24;
+    const unsigned int segments = 48;
+    std::vector<Vertex> vertices;
+    vertices.push_back(Vertex{0, 1, 0, 0, 1, 0, 0, 0});
+    for (unsigned int r = 1; r < rings; ++r) {
+        float theta = 3.14159265f * (float)r / (float)rings;
+        for (unsigned int s = 0; s < segments; ++s) {
+            float phi = 2.0f * 3.14159265f * (float)s / (float)segments;
+            Vector3 p{std::sin(theta) * std::cos(phi), std::cos(theta),
+                      std::sin(theta) * std::sin(phi)};
+            vertices.push_back(Vertex{p.x, p.y, p.z, p.x, p.y, p.z, 0, 0});
+        }
+    }
+    vertices.push_back(Vertex{0, -1, 0, 0, -1, 0, 0, 0});
+    unsigned int south = (unsigned int)vertices.size() - 1;
+
+    auto ring = [&](unsigned int r, unsigned int s) { return 1 + (r - 1) * segments + s % segments; };
+    std::vector<unsigned int> indices;
+    for (unsigned int s = 0; s < segments; ++s) {
+        indices.insert(indices.end(), {0, ring(1, s + 1), ring(1, s)});
+        indices.insert(indices.end(), {south, ring(rings - 1, s), ring(rings - 1, s + 1)});
+        for (unsigned int r = 1; r + 1 < rings; ++r) {
+            indices.insert(indices.end(), {ring(r, s), ring(r, s + 1), ring(r + 1, s + 1)});
+            indices.insert(indices.end(), {ring(r, s), ring(r + 1, s + 1), ring(r + 1, s)});
+        }
+    }
+
+    std::vector<unsigned int> simplified;
+    float error = simplifyMesh(vertices.data(), (unsigned int)vertices.size(), indices.data(),
+                               indices.size(), indices.size() / 4, 1.0f, simplified);
+
+    REQUIRE(simplified.size() <= indices.size() / 4);
+    REQUIRE(simplified.size() > 0);
+    REQUIRE(error < 0.1f);
+
+    // triangles spanning the inside would pull their centers towards the middle
+    for (std::size_t i = 0; i < simplified.size(); i += 3) {
+        Vector3 center{0, 0, 0};
+        for (std::size_t corner = 0; corner < 3; ++corner) {
+            const Vertex &v = vertices[simplified[i + corner]];
+            center = center + Vector3{v.px, v.py, v.pz} * (1.0f / 3.0f);
+        }
+        REQUIRE(center.length() > 0.9f);
+        REQUIRE(cornerNormal(vertices, &simplified[i]).dot(center) > 0.0f);
+    }
+}
@@ -0,0 +1,97 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/random.h"
+#include "../../src/game/pathfinding.h"
+#include "../common/dungeon.h"
+
+TEST_CASE("Following the flow field reaches the target in the shortest number of steps") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+    Dungeon dungeon = makeTestDungeon(jobs, 128);
+
+    FlowField field;
+    initFlowField(field, dungeon);
+    const DungeonSpawn &player = dungeon.spawns[0];
+    REQUIRE(updateFlowField(field, dungeon, player.x, player.y, jobs));
+
+    for (const DungeonSpawn &spawn : dungeon.spawns) {
+        std::uint32_t tile = spawn.y * field.width + spawn.x;
+        std::uint32_t expected = field.distances[tile];
+        REQUIRE(expected != FLOW_UNREACHABLE);
+
+        std::uint32_t steps = 0;
+        while (field.directions[tile] != FLOW_NONE) {
+            switch (field.directions[tile]) {
+            case FLOW_WEST:
+                tile -= 1;
+                break;
+            case FLOW_EAST:
+                tile += 1;
+                break;
+            case FLOW_NORTH:
+                tile -= field.width;
+                break;
+            case FLOW_SOUTH:
+                tile += field.width;
+                break;
+            }
+            REQUIRE(dungeon.tiles[tile] == TILE_FLOOR);
+            ++steps;
+        }
+        REQUIRE(steps == expected);
+        REQUIRE(tile == player.y * field.width + player.x);
+    }
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("The flow field is only rebuilt when the target changes tile") {
+    JobSystem jobs;
+    initJobSystem(jobs, 1);
+    Dungeon dungeon = makeTestDungeon(jobs, 64);
+
+    FlowField field;
+    initFlowField(field, dungeon);
+    const DungeonSpawn &player = dungeon.spawns[0];
+
+    REQUIRE(updateFlowField(field, dungeon, player.x, player.y, jobs));
+    REQUIRE_FALSE(updateFlowField(field, dungeon, player.x, player.y, jobs));
+    REQUIRE(updateFlowField(field, dungeon, player.x + 1, player.y, jobs));
+    REQUIRE(field.rebuilds == 2);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Wall edits patch the flow field to match a full rebuild") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+    Dungeon dungeon = makeTestDungeon(jobs, 96);
+    const DungeonSpawn &player = dungeon.spawns[0];
+
+    FlowField patched;
+    initFlowField(patched, dungeon);
+    updateFlowField(patched, dungeon, player.x, player.y, jobs);
+
+    Random rng = makeRandom(3);
+    for (int round = 0; round < 20; ++round) {
+        for (int edit = 0; edit < 25; ++edit) {
+            std::uint32_t x = (std::uint32_t)randomInt(rng, 0, (std::int32_t)dungeon.width - 1);
+            std::uint32_t y = (std::uint32_t)randomInt(rng, 0, (std::int32_t)dungeon.height - 1);
+            if (x == player.x && y == player.y) {
+                continue;
+            }
+            Tile tile = dungeon.at(x, y) == TILE_FLOOR ? TILE_WALL : TILE_FLOOR;
+            setDungeonTile(patched, dungeon, x, y, tile);
+        }
+        REQUIRE(patched.rebuilds == 1);
+
+        FlowField fresh;
+        initFlowField(fresh, dungeon);
+        updateFlowField(fresh, dungeon, player.x, player.y, jobs);
+
+        REQUIRE(patched.distances == fresh.distances);
+        REQUIRE(patched.directions == fresh.directions);
+    }
+
+    shutdownJobSystem(jobs);
+}
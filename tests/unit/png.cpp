@@ -0,0 +1,114 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <vector>
+
+#include "../../src/core/png.h"
+
+static std::uint32_t readU32(const std::uint8_t *p) {
+    return (std::uint32_t)p[0] << 24 | (std::uint32_t)p[1] << 16 | (std::uint32_t)p[2] << 8 |
+           (std::uint32_t)p[3];
+}
+
+struct PngChunk {
+    char type[5] = {};
+    std::vector<std::uint8_t> data;
+};
+
+// Splits the file into chunks, checking every CRC on the way.
+static std::vector<PngChunk> readChunks(const std::vector<std::uint8_t> &png) {
+    std::vector<PngChunk> chunks;
+    std::size_t offset = 8;
+    while (offset + 12 <= png.size()) {
+        std::uint32_t length = readU32(&png[offset]);
+        REQUIRE(offset + 12 + length <= png.size());
+
+        PngChunk chunk;
+        std::memcpy(chunk.type, &png[offset + 4], 4);
+        chunk.data.assign(png.begin() + (std::ptrdiff_t)(offset + 8),
+                          png.begin() + (std::ptrdiff_t)(offset + 8 + length));
+        REQUIRE(crc32(&png[offset + 4], length + 4) == readU32(&png[offset + 8 + length]));
+
+        chunks.push_back(chunk);
+        offset += 12 + length;
+    }
+    REQUIRE(offset == png.size());
+    return chunks;
+}
+
+// Undoes the stored deflate blocks, only what encodePng writes.
+static std::vector<std::uint8_t> inflateStored(const std::vector<std::uint8_t> &zlib) {
+    std::vector<std::uint8_t> raw;
+    std::size_t offset = 2;
+    bool last = false;
+    while (!last) {
+        last = zlib[offset] & 1;
+        std::uint16_t length = (std::uint16_t)(zlib[offset + 1] | zlib[offset + 2] << 8);
+        std::uint16_t complement = (std::uint16_t)(zlib[offset + 3] | zlib[offset + 4] << 8);
+        REQUIRE((std::uint16_t)~length == complement);
+        raw.insert(raw.end(), zlib.begin() + (std::ptrdiff_t)(offset + 5),
+                   zlib.begin() + (std::ptrdiff_t)(offset + 5 + length));
+        offset += 5 + length;
+    }
+    REQUIRE(offset + 4 == zlib.size());
+    return raw;
+}
+
+TEST_CASE("CRC32 matches the reference check value") {
+    const char *text = "123456789";
+    REQUIRE(crc32(reinterpret_cast<const std::uint8_t *>(text), 9) == 0xCBF43926u);
+}
+
+TEST_CASE("PNG holds the pixels row by row behind a filter byte") {
+    const std::uint32_t width = 3, height = 2;
+    std::vector<std::uint8_t> rgba(width * height * 4);
+    for (std::size_t i = 0; i < rgba.size(); ++i) {
+        rgba[i] = (std::uint8_t)(i * 7);
+    }
+
+    std::vector<std::uint8_t> png;
+    encodePng(width, height, rgba.data(), png);
+
+    const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    REQUIRE(std::memcmp(png.data(), signature, 8) == 0);
+
+    std::vector<PngChunk> chunks = readChunks(png);
+    REQUIRE(chunks.size() == 3);
+    REQUIRE(std::strcmp(chunks[0].type, "IHDR") == 0);
+    REQUIRE(std::strcmp(chunks[1].type, "IDAT") == 0);
+    REQUIRE(std::strcmp(chunks[2].type, "IEND") == 0);
+
+    REQUIRE(readU32(&chunks[0].data[0]) == width);
+    REQUIRE(readU32(&chunks[0].data[4]) == height);
+    REQUIRE(chunks[0].data[8] == 8);
+    REQUIRE(chunks[0].data[9] == 6);
+
+    std::vector<std::uint8_t> raw = inflateStored(chunks[1].data);
+    REQUIRE(raw.size() == (width * 4 + 1) * height);
+    for (std::uint32_t y = 0; y < height; ++y) {
+        REQUIRE(raw[y * (width * 4 + 1)] == 0);
+        REQUIRE(std::memcmp(&raw[y * (width * 4 + 1) + 1], &rgba[y * width * 4], width * 4) ==
+                0);
+    }
+}
+
+TEST_CASE("Large images are split over several stored blocks") {
+    const std::uint32_t width = 256, height = 256;
+    std::vector<std::uint8_t> rgba(width * height * 4, 0xAB);
+
+    std::vector<std::uint8_t> png;
+    encodePng(width, height, rgba.data(), png);
+
+    std::vector<PngChunk> chunks = readChunks(png);
+    std::vector<std::uint8_t> raw = inflateStored(chunks[1].data);
+    REQUIRE(raw.size() == (width * 4 + 1) * height);
+    // more than 65535 bytes need at least 5 stored blocks
+    REQUIRE(chunks[1].data.size() >= raw.size() + 2 + 4 + 5 * 5);
+
+    std::uint32_t a = 1, b = 0;
+    for (std::uint8_t byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    REQUIRE(readU32(&chunks[1].data[chunks[1].data.size() - 4]) == ((b << 16) | a));
+}
@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/pool.h"
+
+struct Item {
+    int value = 0;
+    double payload[3] = {};
+};
+
+TEST_CASE("Pool reuses released slots before growing") {
+    Pool<Item, 4> pool;
+
+    Item *a = pool.alloc();
+    Item *b = pool.alloc();
+    a->value = 1;
+    b->value = 2;
+
+    REQUIRE(pool.stats.capacity == 4);
+    REQUIRE(pool.stats.used == 2);
+
+    pool.release(a);
+    Item *c = pool.alloc();
+    REQUIRE(c == a);
+    REQUIRE(c->value == 0);
+    REQUIRE(b->value == 2);
+
+    REQUIRE(pool.stats.used == 2);
+    REQUIRE(pool.stats.peak == 2);
+    REQUIRE(pool.stats.allocations == 3);
+    REQUIRE(pool.stats.releases == 1);
+}
+
+TEST_CASE("Pool grows by whole chunks and keeps pointers stable") {
+    Pool<Item, 4> pool;
+
+    Item *items[10];
+    for (int i = 0; i < 10; ++i) {
+        items[i] = pool.alloc();
+        items[i]->value = i;
+    }
+
+    REQUIRE(pool.stats.chunks == 3);
+    REQUIRE(pool.stats.capacity == 12);
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(items[i]->value == i);
+    }
+
+    for (Item *item : items) {
+        pool.release(item);
+    }
+    REQUIRE(pool.stats.used == 0);
+    REQUIRE(pool.stats.peak == 10);
+}
@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/profiler.h"
+
+TEST_CASE("Late samples land in their frame until the row closes") {
+    Profiler profiler;
+    std::uint32_t cpu = addProfileScope(profiler, "cpu");
+    std::uint32_t gpu = addProfileScope(profiler, "gpu");
+
+    beginProfileFrame(profiler);
+    REQUIRE(profiler.frame == 0);
+    recordProfileSample(profiler, 0, cpu, 1.0f);
+    recordProfileSample(profiler, 0, cpu, 2.0f);
+
+    for (std::uint32_t i = 1; i < PROFILE_LATENCY; ++i) {
+        beginProfileFrame(profiler);
+    }
+    // still open, the GPU result of frame 0 arrives late
+    recordProfileSample(profiler, 0, gpu, 4.0f);
+    REQUIRE(getProfileStats(profiler, cpu).samples == 0);
+
+    beginProfileFrame(profiler);
+    REQUIRE(getProfileStats(profiler, cpu).samples == 1);
+    REQUIRE(getProfileStats(profiler, cpu).max == 3.0f);
+    REQUIRE(getProfileStats(profiler, gpu).max == 4.0f);
+
+    // frame 0 is closed, too late
+    recordProfileSample(profiler, 0, gpu, 8.0f);
+    closeProfiler(profiler);
+    REQUIRE(getProfileStats(profiler, gpu).samples == 1);
+}
+
+TEST_CASE("Rolling stats only cover the last frames") {
+    Profiler profiler;
+    std::uint32_t scope = addProfileScope(profiler, "scope");
+
+    for (std::uint32_t i = 0; i < PROFILE_HISTORY * 2; ++i) {
+        beginProfileFrame(profiler);
+        recordProfileSample(profiler, profiler.frame, scope, i < PROFILE_HISTORY ? 100.0f : 1.0f);
+    }
+    closeProfiler(profiler);
+
+    ProfileStats stats = getProfileStats(profiler, scope);
+    REQUIRE(stats.samples == PROFILE_HISTORY);
+    REQUIRE(stats.mean == 1.0f);
+    REQUIRE(stats.p99 == 1.0f);
+}
+
+TEST_CASE("The CSV has a row per frame with empty cells for missing samples") {
+    const char *path = "unit_profiler.csv";
+
+    Profiler profiler;
+    std::uint32_t a = addProfileScope(profiler, "a");
+    addProfileScope(profiler, "b");
+    REQUIRE(openProfileCsv(profiler, path));
+
+    for (std::uint32_t i = 0; i < 6; ++i) {
+        beginProfileFrame(profiler);
+        recordProfileSample(profiler, profiler.frame, a, 0.5f);
+    }
+    closeProfiler(profiler);
+
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    REQUIRE(line == "frame,a,b");
+    for (std::uint32_t i = 0; i < 6; ++i) {
+        std::getline(file, line);
+        REQUIRE(line == std::to_string(i) + ",0.5000,");
+    }
+    REQUIRE(!std::getline(file, line));
+
+    file.close();
+    std::remove(path);
+}
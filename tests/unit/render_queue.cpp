@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/render_queue.h"
+
+TEST_CASE("Render keys pack pass, shader, mesh, lod and depth") {
+    std::uint64_t key = makeRenderKey(RENDER_PASS_TRANSPARENT, 7, 300, 2, 2.5f);
+    REQUIRE(renderKeyPass(key) == RENDER_PASS_TRANSPARENT);
+    REQUIRE(renderKeyShader(key) == 7);
+    REQUIRE(renderKeyMesh(key) == 300);
+    REQUIRE(renderKeyLod(key) == 2);
+
+    // state outranks depth, opaque goes front to back and transparent back to front
+    REQUIRE(makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 0, 1000.0f) <
+            makeRenderKey(RENDER_PASS_OPAQUE, 1, 1, 0, 0.0f));
+    REQUIRE(makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 3, 1000.0f) <
+            makeRenderKey(RENDER_PASS_OPAQUE, 1, 1, 0, 0.0f));
+    REQUIRE(makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 0, 1000.0f) <
+            makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 1, 0.0f));
+    REQUIRE(makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 0, 1.0f) <
+            makeRenderKey(RENDER_PASS_OPAQUE, 1, 0, 0, 2.0f));
+    REQUIRE(makeRenderKey(RENDER_PASS_TRANSPARENT, 1, 0, 0, 2.0f) <
+            makeRenderKey(RENDER_PASS_TRANSPARENT, 1, 0, 0, 1.0f));
+    REQUIRE(makeRenderKey(RENDER_PASS_OPAQUE, 1000, 60000, 3, 1e30f) <
+            makeRenderKey(RENDER_PASS_TRANSPARENT, 0, 0, 0, 1e30f));
+}
+
+TEST_CASE("The render queue sorts stably by key") {
+    std::mt19937 rng(4);
+    std::uniform_int_distribution<unsigned int> mesh(0, 5);
+    std::uniform_real_distribution<float> depth(0.0f, 50.0f);
+
+    RenderQueue queue;
+    for (std::uint32_t i = 0; i < 5000; ++i) {
+        // coarse depths so there are plenty of equal keys to check stability on
+        float d = (float)(int)depth(rng);
+        RenderPass pass = i % 7 == 0 ? RENDER_PASS_TRANSPARENT : RENDER_PASS_OPAQUE;
+        pushRenderPacket(queue, makeRenderKey(pass, 3, mesh(rng), 0, d), i);
+    }
+
+    std::vector<RenderPacket> expected = queue.packets;
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const RenderPacket &a, const RenderPacket &b) { return a.key < b.key; });
+
+    sortRenderQueue(queue);
+    REQUIRE(queue.packets.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(queue.packets[i].key == expected[i].key);
+        REQUIRE(queue.packets[i].item == expected[i].item);
+    }
+}
@@ -0,0 +1,112 @@
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/save.h"
+#include "../../src/game/simulation.h"
+#include "../common/world.h"
+
+TEST_CASE("Saves round-trip the world exactly") {
+    Simulation original;
+    initSimulation(original);
+    populateWorld(original, 5000);
+    original.tick = 1234;
+
+    std::string path = tempPath("roguelike_roundtrip.sav");
+    REQUIRE(saveWorld(path.c_str(), original));
+
+    Simulation loaded;
+    initSimulation(loaded);
+    REQUIRE(loadWorld(path.c_str(), loaded));
+
+    REQUIRE(loaded.tick == 1234);
+    REQUIRE(loaded.entities.count() == original.entities.count());
+    REQUIRE(checksumSimulation(loaded) == checksumSimulation(original));
+    REQUIRE(loaded.moving->count() == original.moving->count());
+    REQUIRE(loaded.spatial.count == loaded.entities.count());
+
+    // handles from before the save resolve to the same entities after loading
+    for (std::uint32_t i = 0; i < original.entities.count(); i += 97) {
+        EntityId id = original.entities.ids[i];
+        std::uint32_t dense = getEntityIndex(loaded.entities, id);
+        REQUIRE(dense != ENTITY_INVALID_INDEX);
+        REQUIRE(loaded.entities.positions[dense].x == original.entities.positions[i].x);
+    }
+
+    // the hierarchy comes back with it
+    EntityId child = original.entities.ids[2];
+    EntityId parent = original.entities.parents[2];
+    REQUIRE(parent == original.entities.ids[1]);
+    REQUIRE(loaded.entities.parents[getEntityIndex(loaded.entities, child)] == parent);
+    REQUIRE(loaded.entities.firstChildren[getEntityIndex(loaded.entities, parent)] == child);
+
+    // new entities reuse the freed slots without clashing with loaded handles
+    EntityId fresh = makeEntity(loaded.entities, EntityType::Enemy);
+    REQUIRE(isEntityAlive(loaded.entities, fresh));
+    REQUIRE(loaded.entities.count() == original.entities.count() + 1);
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Corrupt saves are rejected") {
+    Simulation sim;
+    initSimulation(sim);
+    populateWorld(sim, 100);
+
+    std::string path = tempPath("roguelike_corrupt.sav");
+    REQUIRE(saveWorld(path.c_str(), sim));
+
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(SaveHeader) + 5);
+        file.put('\x7f');
+    }
+
+    SaveView view;
+    REQUIRE_FALSE(openSave(path.c_str(), view));
+    REQUIRE(view.mapping == nullptr);
+
+    Simulation target;
+    initSimulation(target);
+    REQUIRE_FALSE(loadWorld(path.c_str(), target));
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Background saves write the same file as blocking ones") {
+    Simulation sim;
+    initSimulation(sim);
+    populateWorld(sim, 5000);
+    sim.tick = 77;
+
+    std::string blockingPath = tempPath("roguelike_blocking.sav");
+    std::string backgroundPath = tempPath("roguelike_background.sav");
+    REQUIRE(saveWorld(blockingPath.c_str(), sim));
+
+    SaveWriter writer;
+    REQUIRE(startSaveWorld(writer, backgroundPath.c_str(), sim));
+    // the world is the caller's again right away
+    destroyEntity(sim.entities, sim.entities.ids[0]);
+    finishSaveWorld(writer);
+    REQUIRE(pollSaveWorld(writer));
+    REQUIRE(writer.saves == 1);
+    REQUIRE(writer.failures == 0);
+
+    auto readAll = [](const std::string &path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), {});
+    };
+    REQUIRE(readAll(backgroundPath) == readAll(blockingPath));
+
+    // the writer can be reused, and reports saves that fail
+    REQUIRE(startSaveWorld(writer, "/nonexistent/roguelike.sav", sim));
+    finishSaveWorld(writer);
+    REQUIRE(writer.saves == 1);
+    REQUIRE(writer.failures == 1);
+
+    std::remove(blockingPath.c_str());
+    std::remove(backgroundPath.c_str());
+}
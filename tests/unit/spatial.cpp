@@ -0,0 +1,112 @@
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/simulation.h"
+#include "../common/spatial.h"
+
+// every live entity is indexed where the store has it, and nothing else is
+static void requireInStep(const SpatialHash &hash, const EntityManager &manager) {
+    REQUIRE(hash.count == manager.count());
+    for (std::uint32_t i = 0; i < manager.count(); ++i) {
+        EntityId id = manager.ids[i];
+        REQUIRE(spatialContains(hash, id));
+        std::uint32_t index = entityIdIndex(id);
+        const SpatialEntry &entry = hash.cells[hash.entityCell[index]][hash.entitySlot[index]];
+        REQUIRE(entry.position.x == manager.positions[i].x);
+        REQUIRE(entry.position.z == manager.positions[i].z);
+    }
+}
+
+TEST_CASE("Spatial hash queries match a linear scan") {
+    EntityManager manager;
+    populateScattered(manager, 5000, 200.0f);
+
+    SpatialHash hash;
+    initSpatialHash(hash, 4.0f);
+    spatialSync(hash, manager);
+    REQUIRE(hash.count == 5000);
+
+    Vector3 center = Vector3{10, 0, -20};
+
+    std::vector<EntityId> expected;
+    std::vector<EntityId> actual;
+    bruteForceRadius(manager, center, 25.0f, expected);
+    spatialQueryRadius(hash, center, 25.0f, actual);
+    std::sort(expected.begin(), expected.end());
+    std::sort(actual.begin(), actual.end());
+    REQUIRE(actual == expected);
+
+    actual.clear();
+    spatialQueryNearest(hash, center, 8, actual);
+    REQUIRE(actual.size() == 8);
+    // nothing outside the result may be closer than the furthest result
+    auto distance = [&](EntityId id) {
+        Vector3 p = manager.positions[getEntityIndex(manager, id)];
+        return (p - center).length();
+    };
+    float furthest = distance(actual.back());
+    for (std::uint32_t i = 0; i < manager.count(); ++i) {
+        if (std::find(actual.begin(), actual.end(), manager.ids[i]) == actual.end()) {
+            REQUIRE(distance(manager.ids[i]) >= furthest);
+        }
+    }
+
+    EntityId moved = manager.ids[0];
+    EntityId destroyed = manager.ids[1];
+    spatialMove(hash, moved, Vector3{1000, 0, 1000});
+    spatialRemove(hash, destroyed);
+
+    REQUIRE(hash.count == 4999);
+    REQUIRE_FALSE(spatialContains(hash, destroyed));
+
+    actual.clear();
+    spatialQueryAabb(hash, Vector3{999, -1, 999}, Vector3{1001, 1, 1001}, actual);
+    REQUIRE(actual == std::vector<EntityId>{moved});
+}
+
+TEST_CASE("Ticks keep the spatial hash in step with spawns, despawns and movement") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    Simulation sim;
+    initSimulation(sim);
+    EntityManager &manager = sim.entities;
+
+    populateScattered(manager, 2000, 100.0f);
+    spatialSync(sim.spatial, manager);
+
+    // some walk, fast enough to cross cells
+    for (std::uint32_t i = 0; i < manager.count(); i += 3) {
+        manager.velocities[i] = Vector3{60, 0, -30};
+    }
+    // a parent that is about to go, its children are re-rooted where they stand
+    EntityId parent = manager.ids[10];
+    manager.positions[getEntityIndex(manager, parent)] = Vector3{50, 0, 50};
+    setParent(manager, manager.ids[11], parent);
+    setParent(manager, manager.ids[12], parent);
+
+    std::vector<EntityId> spawned;
+    for (std::uint32_t i = 0; i < 100; ++i) {
+        spawned.push_back(recordCreateEntity(sim.commands, manager, EntityType::Enemy,
+                                             Vector3{(float)i, 0, -(float)i}));
+    }
+    recordDestroyEntity(sim.commands, parent);
+    for (std::uint32_t i = 100; i < 200; ++i) {
+        recordDestroyEntity(sim.commands, manager.ids[i]);
+    }
+    // spawned and gone within the same tick
+    recordDestroyEntity(sim.commands, spawned[0]);
+
+    for (int tick = 0; tick < 10; ++tick) {
+        updateSimulation(sim, jobs, 1.0f / 60.0f);
+        requireInStep(sim.spatial, manager);
+    }
+    REQUIRE(manager.count() == 2000 + 100 - 1 - 100 - 1);
+    REQUIRE_FALSE(spatialContains(sim.spatial, parent));
+    REQUIRE_FALSE(spatialContains(sim.spatial, spawned[0]));
+    REQUIRE(spatialContains(sim.spatial, spawned[1]));
+
+    shutdownSimulation(sim);
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,54 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/graphics/stream_buffer.h"
+#include "../common/stream.h"
+
+TEST_CASE("Stream allocations are aligned and stay inside their frame's region") {
+    StreamBuffer stream;
+    stream.regionSize = 1024;
+
+    REQUIRE(allocStream(stream, 64, 256) == 0);
+    REQUIRE(allocStream(stream, 4, 4) == 64);
+    // padded up to the alignment
+    REQUIRE(allocStream(stream, 64, 256) == 256);
+    REQUIRE(allocStream(stream, 16, 64) == 320);
+    REQUIRE(stream.head == 336);
+
+    // frame 2 writes the third region, offsets are into the whole buffer
+    stream.region = 2;
+    stream.head = 0;
+    REQUIRE(allocStream(stream, 512, 256) == 2048);
+    REQUIRE(allocStream(stream, 512, 256) == 2048 + 512);
+    REQUIRE(stream.head == stream.regionSize);
+    REQUIRE(stream.peak == stream.regionSize);
+}
+
+TEST_CASE("A full region reports no space instead of spilling into the next one") {
+    StreamBuffer stream;
+    stream.regionSize = 1024;
+
+    REQUIRE(allocStream(stream, 1000, 16) == 0);
+    REQUIRE(allocStream(stream, 32, 16) == STREAM_NO_SPACE);
+    // failed allocations don't move the head, smaller ones still fit
+    REQUIRE(stream.head == 1000);
+    REQUIRE(allocStream(stream, 16, 16) == 1008);
+    REQUIRE(allocStream(stream, 8, 256) == STREAM_NO_SPACE);
+}
+
+TEST_CASE("Streamed frames reuse the same three regions") {
+    StreamBuffer stream;
+    std::vector<std::uint8_t> memory;
+    initHostStream(stream, memory, 1 << 20);
+
+    Mat4 viewProj{};
+    std::vector<Mat4> models(4096);
+    for (std::uint32_t frame = 0; frame < 3000; ++frame) {
+        std::size_t offset = streamFrame(stream, viewProj, models);
+        // right behind the uniforms, at the start of their region
+        REQUIRE(offset == (frame % STREAM_FRAMES) * stream.regionSize + sizeof(Mat4));
+    }
+    REQUIRE(stream.grows == 0);
+    REQUIRE(stream.peak == (models.size() + 1) * sizeof(Mat4));
+}
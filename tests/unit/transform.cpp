@@ -0,0 +1,196 @@
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/entity.h"
+#include "../../src/game/transform.h"
+
+static EntityId makeAt(EntityManager &manager, Vector3 position, Vector3 scale = {1, 1, 1}) {
+    EntityId id = makeEntity(manager, EntityType::Prop);
+    std::uint32_t row = getEntityIndex(manager, id);
+    manager.positions[row] = position;
+    manager.scales[row] = scale;
+    return id;
+}
+
+static Vector3 worldPosition(const EntityManager &manager, EntityId id) {
+    return transformPosition(manager.worldTransforms[getEntityIndex(manager, id)]);
+}
+
+TEST_CASE("Children follow their parent") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    EntityManager manager;
+    EntityId wielder = makeAt(manager, Vector3{2, 0, 0}, Vector3{2, 2, 2});
+    EntityId weapon = makeAt(manager, Vector3{1, 0.5f, 0});
+    REQUIRE(setParent(manager, weapon, wielder));
+
+    REQUIRE(updateTransforms(manager, jobs) == 2);
+    REQUIRE(worldPosition(manager, weapon).x == 4.0f);
+    REQUIRE(worldPosition(manager, weapon).y == 1.0f);
+    REQUIRE(transformScale(manager.worldTransforms[getEntityIndex(manager, weapon)]).z == 2.0f);
+
+    // only the moved parent is marked, the child is updated through it
+    std::uint32_t row = getEntityIndex(manager, wielder);
+    manager.positions[row] = Vector3{10, 0, 0};
+    markTransformDirty(manager, row);
+    REQUIRE(updateTransforms(manager, jobs) == 2);
+    REQUIRE(worldPosition(manager, weapon).x == 12.0f);
+
+    // detached, its position is in world space again
+    REQUIRE(setParent(manager, weapon, ENTITY_INVALID_ID));
+    REQUIRE(updateTransforms(manager, jobs) == 1);
+    REQUIRE(worldPosition(manager, weapon).x == 1.0f);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Unchanged transforms are not recomputed") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    EntityManager manager;
+    std::vector<EntityId> props;
+    for (int i = 0; i < 1000; ++i) {
+        props.push_back(makeAt(manager, Vector3{(float)i, 0, 0}));
+    }
+
+    REQUIRE(updateTransforms(manager, jobs) == 1000);
+    REQUIRE(updateTransforms(manager, jobs) == 0);
+
+    markTransformDirty(manager, getEntityIndex(manager, props[500]));
+    markTransformDirty(manager, getEntityIndex(manager, props[500]));
+    REQUIRE(updateTransforms(manager, jobs) == 1);
+
+    // a destroyed entity left on the dirty list is skipped
+    EntityId gone = makeAt(manager, Vector3{0, 0, 0});
+    destroyEntity(manager, gone);
+    REQUIRE(updateTransforms(manager, jobs) == 0);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Parenting rejects cycles and stale handles") {
+    EntityManager manager;
+    EntityId a = makeAt(manager, Vector3{0, 0, 0});
+    EntityId b = makeAt(manager, Vector3{0, 0, 0});
+    EntityId c = makeAt(manager, Vector3{0, 0, 0});
+
+    REQUIRE(setParent(manager, b, a));
+    REQUIRE(setParent(manager, c, b));
+    REQUIRE_FALSE(setParent(manager, a, c));
+    REQUIRE_FALSE(setParent(manager, a, a));
+
+    EntityId dead = makeAt(manager, Vector3{0, 0, 0});
+    destroyEntity(manager, dead);
+    REQUIRE_FALSE(setParent(manager, c, dead));
+    REQUIRE_FALSE(setParent(manager, dead, a));
+    REQUIRE(manager.parents[getEntityIndex(manager, c)] == b);
+}
+
+TEST_CASE("Destroying a parent leaves its children in place") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    EntityManager manager;
+    EntityId parent = makeAt(manager, Vector3{5, 0, 5}, Vector3{2, 2, 2});
+    EntityId children[3];
+    for (int i = 0; i < 3; ++i) {
+        children[i] = makeAt(manager, Vector3{(float)i, 0, 0});
+        REQUIRE(setParent(manager, children[i], parent));
+    }
+    updateTransforms(manager, jobs);
+
+    // unlinking from the middle of the sibling list
+    destroyEntity(manager, children[1]);
+    std::uint32_t siblings = 0;
+    for (EntityId child = manager.firstChildren[getEntityIndex(manager, parent)];
+         child != ENTITY_INVALID_ID; child = manager.nextSiblings[getEntityIndex(manager, child)]) {
+        REQUIRE(child != children[1]);
+        ++siblings;
+    }
+    REQUIRE(siblings == 2);
+
+    destroyEntity(manager, parent);
+    std::uint32_t row = getEntityIndex(manager, children[2]);
+    REQUIRE(manager.parents[row] == ENTITY_INVALID_ID);
+    REQUIRE(manager.positions[row].x == 9.0f);
+    REQUIRE(manager.scales[row].y == 2.0f);
+
+    REQUIRE(updateTransforms(manager, jobs) == 2);
+    REQUIRE(worldPosition(manager, children[2]).x == 9.0f);
+    REQUIRE(worldPosition(manager, children[0]).z == 5.0f);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Orphans keep the placement their parent had this tick") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    EntityManager manager;
+    EntityId root = makeAt(manager, Vector3{0, 0, 0}, Vector3{2, 2, 2});
+    EntityId parent = makeAt(manager, Vector3{1, 0, 0});
+    EntityId child = makeAt(manager, Vector3{1, 0, 0});
+    REQUIRE(setParent(manager, parent, root));
+    REQUIRE(setParent(manager, child, parent));
+    updateTransforms(manager, jobs);
+    REQUIRE(worldPosition(manager, child).x == 4.0f);
+
+    // both move and the parent is destroyed before the cached matrices catch up, like a tick
+    // that integrates and then applies a destroy command
+    manager.positions[getEntityIndex(manager, root)] = Vector3{10, 0, 0};
+    markTransformDirty(manager, getEntityIndex(manager, root));
+    manager.positions[getEntityIndex(manager, parent)] = Vector3{3, 0, 0};
+    markTransformDirty(manager, getEntityIndex(manager, parent));
+    destroyEntity(manager, parent);
+
+    std::uint32_t row = getEntityIndex(manager, child);
+    REQUIRE(manager.parents[row] == ENTITY_INVALID_ID);
+    REQUIRE(manager.positions[row].x == 18.0f);
+    REQUIRE(manager.scales[row].x == 2.0f);
+
+    updateTransforms(manager, jobs);
+    REQUIRE(worldPosition(manager, child).x == 18.0f);
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("Many hierarchies update in parallel") {
+    JobSystem jobs;
+    initJobSystem(jobs, 4);
+
+    // 2000 chains of four, each link one unit further along x
+    EntityManager manager;
+    std::vector<EntityId> tips;
+    for (int chain = 0; chain < 2000; ++chain) {
+        EntityId parent = makeAt(manager, Vector3{0, 0, (float)chain});
+        for (int depth = 1; depth < 4; ++depth) {
+            EntityId child = makeAt(manager, Vector3{1, 0, 0});
+            REQUIRE(setParent(manager, child, parent));
+            parent = child;
+        }
+        tips.push_back(parent);
+    }
+
+    REQUIRE(updateTransforms(manager, jobs) == 8000);
+    for (std::size_t chain = 0; chain < tips.size(); ++chain) {
+        Vector3 tip = worldPosition(manager, tips[chain]);
+        REQUIRE(tip.x == 3.0f);
+        REQUIRE(tip.z == (float)chain);
+    }
+
+    // moving every root and one tip updates each chain once
+    for (std::uint32_t row = 0; row < manager.count(); ++row) {
+        if (manager.parents[row] == ENTITY_INVALID_ID) {
+            manager.positions[row].y = 1.0f;
+            markTransformDirty(manager, row);
+        }
+    }
+    markTransformDirty(manager, getEntityIndex(manager, tips[7]));
+    REQUIRE(updateTransforms(manager, jobs) == 8000);
+    REQUIRE(worldPosition(manager, tips[7]).y == 1.0f);
+
+    shutdownJobSystem(jobs);
+}
@@ -0,0 +1,44 @@
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/core/triple_buffer.h"
+
+TEST_CASE("Triple buffer hands the reader the latest published value") {
+    TripleBuffer<int> buffer;
+
+    REQUIRE_FALSE(buffer.acquire());
+
+    buffer.writeBuffer() = 1;
+    buffer.publish();
+    buffer.writeBuffer() = 2;
+    buffer.publish();
+
+    REQUIRE(buffer.hasNew());
+    REQUIRE(buffer.acquire());
+    REQUIRE(buffer.readBuffer() == 2);
+    REQUIRE_FALSE(buffer.acquire());
+    REQUIRE(buffer.readBuffer() == 2);
+}
+
+TEST_CASE("Triple buffer reader never sees values go backwards") {
+    TripleBuffer<int> buffer;
+    buffer.readBuffer() = 0;
+
+    std::thread writer([&] {
+        for (int i = 1; i <= 100000; ++i) {
+            buffer.writeBuffer() = i;
+            buffer.publish();
+        }
+    });
+
+    int last = 0;
+    while (last < 100000) {
+        if (buffer.acquire()) {
+            REQUIRE(buffer.readBuffer() > last);
+            last = buffer.readBuffer();
+        }
+    }
+
+    writer.join();
+}
@@ -0,0 +1,115 @@
+#include <cmath>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../../src/game/dungeon_mesh.h"
+#include "../../src/graphics/vertex_format.h"
+#include "../common/vertices.h"
+
+TEST_CASE("Packed vertices are half the size") {
+    REQUIRE(sizeof(Vertex) == 32);
+    REQUIRE(sizeof(PackedVertex) == 16);
+}
+
+TEST_CASE("Half floats round to nearest even") {
+    REQUIRE(halfToFloat(floatToHalf(1.0f)) == 1.0f);
+    REQUIRE(halfToFloat(floatToHalf(-0.5f)) == -0.5f);
+    REQUIRE(halfToFloat(floatToHalf(65504.0f)) == 65504.0f);
+    REQUIRE(std::isinf(halfToFloat(floatToHalf(1e6f))));
+    // smallest denormal
+    REQUIRE(halfToFloat(floatToHalf(std::ldexp(1.0f, -24))) == std::ldexp(1.0f, -24));
+    // halfway between 1 and the next half (1 + 2^-10) goes to the even one
+    REQUIRE(halfToFloat(floatToHalf(1.0f + std::ldexp(1.0f, -11))) == 1.0f);
+    REQUIRE(halfToFloat(floatToHalf(1.0f + 3 * std::ldexp(1.0f, -11))) ==
+            1.0f + std::ldexp(1.0f, -9));
+}
+
+TEST_CASE("Packing stays within its tolerances") {
+    std::vector<Vertex> vertices = makeVertices(10000, 4.0f, 1.0f);
+    REQUIRE(chooseVertexFormat(vertices.data(), (unsigned int)vertices.size()) ==
+            VERTEX_FORMAT_PACKED);
+
+    std::vector<PackedVertex> packed(vertices.size());
+    VertexQuantization quantization =
+        packVertices(vertices.data(), (unsigned int)vertices.size(), packed.data());
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex &v = vertices[i];
+        Vector3 position = unpackPosition(packed[i], quantization);
+        REQUIRE(std::abs(position.x - v.px) <= PACKED_POSITION_TOLERANCE);
+        REQUIRE(std::abs(position.y - v.py) <= PACKED_POSITION_TOLERANCE);
+        REQUIRE(std::abs(position.z - v.pz) <= PACKED_POSITION_TOLERANCE);
+
+        Vector3 normal = octDecode(packed[i].nx, packed[i].ny);
+        REQUIRE(normal.dot(Vector3{v.nx, v.ny, v.nz}) > 0.9999f);
+
+        REQUIRE(std::abs(halfToFloat(packed[i].u) - v.u) <= PACKED_UV_TOLERANCE);
+    }
+}
+
+TEST_CASE("Meshes that can't be packed keep full floats") {
+    // fractional UVs up to 512 are only stored to 1/4 or 1/2 as halfs
+    std::vector<Vertex> fractional = makeVertices(1000, 4.0f, 512.0f);
+    REQUIRE(chooseVertexFormat(fractional.data(), (unsigned int)fractional.size()) ==
+            VERTEX_FORMAT_FLOAT);
+
+    std::vector<Vertex> huge = makeVertices(1000, 5000.0f, 1.0f);
+    REQUIRE(chooseVertexFormat(huge.data(), (unsigned int)huge.size()) == VERTEX_FORMAT_FLOAT);
+}
+
+// Checks that `vertices` pack, and that they come back within the position tolerance with their
+// integer world space UVs exact.
+static void requirePacksExactly(const std::vector<Vertex> &vertices) {
+    REQUIRE(chooseVertexFormat(vertices.data(), (unsigned int)vertices.size()) ==
+            VERTEX_FORMAT_PACKED);
+
+    std::vector<PackedVertex> packed(vertices.size());
+    VertexQuantization quantization =
+        packVertices(vertices.data(), (unsigned int)vertices.size(), packed.data());
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const Vertex &v = vertices[i];
+        Vector3 position = unpackPosition(packed[i], quantization);
+        REQUIRE(std::abs(position.x - v.px) <= PACKED_POSITION_TOLERANCE);
+        REQUIRE(std::abs(position.z - v.pz) <= PACKED_POSITION_TOLERANCE);
+        REQUIRE(halfToFloat(packed[i].u) == v.u);
+        REQUIRE(halfToFloat(packed[i].v) == v.v);
+    }
+}
+
+TEST_CASE("Dungeon chunks are stored packed") {
+    JobSystem jobs;
+    initJobSystem(jobs, 2);
+
+    DungeonConfig config; // 512x512 in 32x32 chunks
+    Dungeon dungeon;
+    generateDungeon(dungeon, config, jobs);
+
+    DungeonMesher mesher;
+    initDungeonMesher(mesher, dungeon, config.chunkSize);
+
+    // the last chunk has the largest world space UVs
+    DungeonChunkTiles tiles;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    for (std::uint32_t chunk : {0u, (std::uint32_t)mesher.chunks.size() - 1}) {
+        copyDungeonChunk(dungeon, mesher, chunk, tiles);
+        buildDungeonChunkGeometry(tiles, vertices, indices);
+        REQUIRE(!vertices.empty());
+        requirePacksExactly(vertices);
+    }
+
+    shutdownJobSystem(jobs);
+}
+
+TEST_CASE("A floor across the whole map still packs") {
+    // one quad over 512x512 tiles, UVs at the corners up to 512 and a 512 unit extent, which
+    // quantizes to 512 / 65535 / 2 ~ 0.004, inside the position tolerance
+    std::vector<Vertex> floor = {
+        Vertex{0, 0, 0, 0, 1, 0, 0, 0},
+        Vertex{512, 0, 0, 0, 1, 0, 512, 0},
+        Vertex{512, 0, 512, 0, 1, 0, 512, 512},
+        Vertex{0, 0, 512, 0, 1, 0, 0, 512},
+    };
+    requirePacksExactly(floor);
+}